@@ -0,0 +1,38 @@
+#ifndef ADV_POLICY_H
+#define ADV_POLICY_H
+
+#include <stdint.h>
+
+enum AdvMode : uint8_t {
+    ADV_MODE_OFF = 0,
+    ADV_MODE_FAST,
+    ADV_MODE_SLOW,
+};
+
+struct AdvStats {
+    uint32_t connects;
+    uint32_t fastConnects;
+    uint32_t slowConnects;
+    uint32_t lastTimeToConnectMs;
+    uint32_t minTimeToConnectMs;
+    uint32_t maxTimeToConnectMs;
+    uint64_t totalTimeToConnectMs;
+};
+
+struct AdvPolicy {
+    AdvMode mode;
+    uint8_t connections;
+    uint8_t maxConnections;
+    uint32_t fastBurstMs;
+    uint32_t modeStart;
+    uint32_t advertisingStart;
+    AdvStats stats;
+};
+
+void advPolicyInit(AdvPolicy &policy, uint8_t maxConnections, uint32_t fastBurstMs, uint32_t now);
+void advPolicyOnConnect(AdvPolicy &policy, uint32_t now);
+void advPolicyOnDisconnect(AdvPolicy &policy, uint32_t now);
+AdvMode advPolicyUpdate(AdvPolicy &policy, uint32_t now);
+uint32_t advPolicyAverageTimeToConnect(const AdvPolicy &policy);
+
+#endif
@@ -10,5 +10,8 @@ void updateBatteryLevelBLE();
 float readBatteryVoltage();
 int batteryPercent(float voltage);
 void ensureBLEAdvertising();
+void updateStateBLE();
+void updateLinkPolicy();
+void noteLinkWrite(uint16_t connHandle, size_t length, bool bulk);
 
 #endif
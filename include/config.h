@@ -10,6 +10,10 @@
 // Define a unique 128-bit UUID for your BLE service
 #define LIGHT_SERVICE_UUID "12345678-1234-5678-1234-56789abcdef0"        // Custom Service
 #define LIGHT_CHARACTERISTIC_UUID "abcdef01-1234-5678-1234-56789abcdef0" // Light Color
+#define STATE_CHARACTERISTIC_UUID "abcdef02-1234-5678-1234-56789abcdef0" // Packed device state snapshot
+#define OTA_SERVICE_UUID "12345678-1234-5678-1234-56789abcdef1"                // Firmware Update Service
+#define OTA_CONTROL_CHARACTERISTIC_UUID "abcdef10-1234-5678-1234-56789abcdef0" // OTA control / status
+#define OTA_DATA_CHARACTERISTIC_UUID "abcdef11-1234-5678-1234-56789abcdef0"    // OTA image chunks
 
 // https://files.seeedstudio.com/wiki/XIAO_WiFi/pin_map-2.png
 
@@ -26,6 +30,58 @@
 #define LONG_PRESS_DELAY 2000     // Long press time in milliseconds (2 seconds)
 #define RESET_BUTTON_PIN 3        // GPIO3 - Button resetting the device
 
+// LED render task
+#define RENDER_FRAME_INTERVAL_MS 10   // Frame boundary period (100 Hz max)
+#define RENDER_TASK_PRIORITY 2        // Above loop() (1), below the NimBLE host task
+#define RENDER_TASK_STACK_SIZE 4096
+
+// Animation frame-rate governor
+#define FRAME_INTERVAL_MIN_MS RENDER_FRAME_INTERVAL_MS // Fastest animation frame interval
+#define FRAME_INTERVAL_MAX_MS 100                      // Slowest animation frame interval (10 fps)
+#define FRAME_INTERVAL_LOW_BATTERY_MS 33               // Fastest interval on low battery (~30 fps)
+#define GOVERNOR_LOW_BATTERY_PERCENT 25                // Battery level considered low
+#define FRAME_DELTA_HIGH 6                             // Max channel change per frame treated as fast motion
+#define FRAME_DELTA_LOW 2                              // Max channel change per frame treated as still
+
+// Frame power budget (per-channel current at full brightness, per LED)
+#define LED_CURRENT_R_UA 12000       // 12 mA
+#define LED_CURRENT_G_UA 12000       // 12 mA
+#define LED_CURRENT_B_UA 12000       // 12 mA
+#define LED_CURRENT_W_UA 18000       // 18 mA
+#define LED_CURRENT_IDLE_UA 1000     // Quiescent current of each LED driver
+#define POWER_BUDGET_MA 220          // Budget with a healthy battery
+#define POWER_BUDGET_MIN_MA 80       // Budget with an empty battery
+#define POWER_BUDGET_FULL_PERCENT 50 // Budget tightens linearly below this battery level
+
+// BLE advertising policy (intervals in 0.625 ms units)
+#define ADV_FAST_INTERVAL_MIN 32   // 20 ms
+#define ADV_FAST_INTERVAL_MAX 48   // 30 ms
+#define ADV_SLOW_INTERVAL_MIN 1636 // 1022.5 ms
+#define ADV_SLOW_INTERVAL_MAX 2056 // 1285 ms
+#define ADV_FAST_BURST_MS 30000    // Fast advertising after boot, wake-up or disconnect
+#define ADV_RETRY_DELAY_MS 1000    // Delay before retrying a failed advertising start
+#define BLE_MAX_CONNECTIONS 3      // Advertising stops once this many centrals are connected
+#define STATE_PUBLISH_INTERVAL_MS 200 // Min interval between state snapshot characteristic updates
+
+// Connection parameter policy (intervals in 1.25 ms units, timeouts in 10 ms units)
+#define LINK_FAST_INTERVAL_MIN 12    // 15 ms while streaming or uploading, the iOS minimum
+#define LINK_FAST_INTERVAL_MAX 12    // 15 ms (iOS requires max >= min + 15 ms unless both are 15 ms)
+#define LINK_FAST_TIMEOUT 400        // 4 s
+#define LINK_IDLE_INTERVAL_MIN 144   // 180 ms when idle
+#define LINK_IDLE_INTERVAL_MAX 160   // 200 ms
+#define LINK_IDLE_LATENCY 4          // Skip up to 4 events when idle (~1 s effective)
+#define LINK_IDLE_TIMEOUT 600        // 6 s
+#define LINK_STREAM_WINDOW_MS 1000   // Window for counting light writes
+#define LINK_STREAM_MIN_WRITES 4     // Writes per window that count as streaming
+#define LINK_IDLE_TIMEOUT_MS 5000    // Fall back to idle parameters after this long without activity
+#define LINK_DATA_LENGTH 251         // LE data length extension, max octets per packet
+#define LINK_PREFERRED_MTU 247       // Fills one 251-byte link layer packet
+
+// Shared animation time base
+#define TIME_SYNC_MAX_DRIFT_PPM 1000         // Clamp for drift correction (crystal + RC tolerance)
+#define TIME_SYNC_MIN_DRIFT_WINDOW_MS 10000  // Minimum interval between syncs used to estimate drift
+#define TIME_SYNC_DRIFT_GAIN_DIV 4           // Drift estimate moves 1/N of the measured error per sync
+
 // BLE Commands
 #define CMD_SET_COLOR 0x01           // Set a single RGBW color
 #define CMD_SET_COLOR_SETS 0x02      // Set multiple colors
@@ -33,6 +89,10 @@
 #define CMD_SET_INDIVIDUAL_COLORS 0x04 // Set individual color for each LED
 #define CMD_SET_SLEEP_TIMER 0x05     // Set sleep timer (minutes)
 #define CMD_SET_ANIMATION 0x06       // Set animation mode
+#define CMD_SET_TIME_SYNC 0x07       // Set shared animation clock and drift correction
+#define CMD_SET_PALETTE 0x08         // Upload palette entries for this connection
+#define CMD_SET_INDEXED_COLORS 0x09  // Set LED colors from palette indices (4 or 8 bits per pixel)
+#define CMD_SET_PACKED_COLORS 0x0A   // Set LED colors in a reduced-depth packed format
 
 // Storage namespace for Preferences API
 #define STORAGE_NAMESPACE "color_storage"
@@ -0,0 +1,24 @@
+#ifndef FRAME_GOVERNOR_H
+#define FRAME_GOVERNOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct FrameGovernor {
+    uint16_t intervalMs;
+    uint32_t lastRenderMs;
+    uint32_t rendered;
+    uint32_t shown;
+    uint32_t dropped;
+    uint32_t windowStartMs;
+    uint32_t windowShown;
+    uint16_t effectiveFpsX10;
+};
+
+void frameGovernorInit(FrameGovernor &governor, uint32_t now);
+bool frameGovernorDue(const FrameGovernor &governor, uint32_t now);
+uint8_t frameDelta(const uint8_t *current, const uint8_t *previous, size_t length);
+void frameGovernorUpdate(FrameGovernor &governor, uint8_t delta, bool shown, int batteryPercent, uint32_t now);
+void frameGovernorIdle(FrameGovernor &governor, uint32_t now);
+
+#endif
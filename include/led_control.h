@@ -2,7 +2,6 @@
 #define LED_CONTROL_H
 
 #include <Arduino.h>
-#include <Adafruit_NeoPixel.h>
 
 void initLEDs();
 void setColorFromBytes(const uint8_t *colorData);
@@ -12,9 +11,14 @@ void loadStoredColors();
 void turnOffLEDs();
 void flashAllColorsAnimation(unsigned int delayMs);
 void setIndividualLEDColors(const uint8_t *colorData, size_t numLEDs);
+void setIndexedLEDColors(uint16_t start, const uint8_t *data, size_t length, uint8_t format, const uint8_t (*palette)[4]);
+void setPackedLEDColors(uint16_t start, const uint8_t *data, size_t length, uint8_t format);
 void setSleepTimer(uint16_t minutes);
-void setAnimation(uint8_t animationType, uint8_t speed, uint8_t *params, size_t paramsLength);
+void setAnimation(uint8_t animationType, uint8_t speed, const uint8_t *params, size_t paramsLength);
 void updateAnimation();
+bool isAnimationActive();
+void setTimeSync(uint32_t sharedMs, int32_t driftPpm, bool estimateDrift);
+uint32_t getSyncedTime();
 bool checkSleepTimer();
 
 #endif
@@ -0,0 +1,46 @@
+#ifndef LINK_POLICY_H
+#define LINK_POLICY_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+enum LinkWorkload : uint8_t {
+    LINK_IDLE = 0,
+    LINK_STREAMING,
+    LINK_BULK,
+};
+
+struct LinkParams {
+    uint16_t minInterval; // 1.25 ms units
+    uint16_t maxInterval; // 1.25 ms units
+    uint16_t latency;     // Connection events the peripheral may skip
+    uint16_t timeout;     // 10 ms units
+    bool phy2M;
+};
+
+struct LinkPolicy {
+    LinkWorkload workload;
+    uint32_t lastActivityMs;
+    uint32_t windowStartMs;
+    uint16_t windowWrites;
+};
+
+// Negotiated values of a connection, as reported by the stack
+struct LinkInfo {
+    uint16_t connHandle;
+    uint16_t interval;
+    uint16_t latency;
+    uint16_t timeout;
+    uint8_t txPhy;
+    uint8_t rxPhy;
+    uint16_t mtu;
+    uint8_t workload;
+    uint32_t bytesWritten;
+};
+
+void linkPolicyInit(LinkPolicy &policy, uint32_t now);
+void linkPolicyOnWrite(LinkPolicy &policy, bool bulk, uint32_t now);
+bool linkPolicyUpdate(LinkPolicy &policy, uint32_t now);
+const LinkParams &linkParamsFor(LinkWorkload workload);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef OTA_SERVICE_H
+#define OTA_SERVICE_H
+
+#include <Arduino.h>
+
+class NimBLEServer;
+
+void initOTAService(NimBLEServer *server);
+void updateOTA();
+bool isOTAInProgress();
+void confirmOTABoot();
+void rejectOTABoot();
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef OTA_SESSION_H
+#define OTA_SESSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#define OTA_HASH_SIZE 32       // SHA-256
+#define OTA_BUFFER_SIZE 4096   // One flash sector per buffer
+#define OTA_CHUNK_MAX 242      // Max image bytes per data write (after the 2-byte sequence number)
+#define OTA_WINDOW_CHUNKS 16   // Max unacknowledged chunks in flight
+#define OTA_ACK_EVERY 8        // Acknowledge after this many chunks
+
+static_assert(OTA_WINDOW_CHUNKS * OTA_CHUNK_MAX <= OTA_BUFFER_SIZE, "OTA window must fit in one buffer");
+
+class OtaFlashBackend
+{
+public:
+    virtual ~OtaFlashBackend() {}
+    virtual bool begin(uint32_t imageSize) = 0;
+    virtual bool write(const uint8_t *data, size_t length) = 0;
+    virtual bool finish(const uint8_t *expectedHash) = 0;
+    virtual void abort() = 0;
+};
+
+enum OtaState : uint8_t {
+    OTA_IDLE = 0,
+    OTA_RECEIVING,
+    OTA_DONE,
+    OTA_FAILED,
+};
+
+enum OtaStatus : uint8_t {
+    OTA_STATUS_NONE = 0,
+    OTA_STATUS_READY,
+    OTA_STATUS_ACK,
+    OTA_STATUS_NACK,
+    OTA_STATUS_DONE,
+    OTA_STATUS_ERROR,
+};
+
+// The receiving (BLE host) side and the flashing (loop) side hand buffers over
+// through the atomic flags: contents and lengths are published with a release
+// store and only read after an acquire load of the same flag.
+struct OtaSession {
+    OtaFlashBackend *backend;
+    std::atomic<OtaState> state;
+    uint32_t imageSize;
+    uint8_t expectedHash[OTA_HASH_SIZE];
+    uint32_t startMs;
+    uint32_t endMs;
+
+    // Written by the receiving side only
+    std::atomic<uint16_t> nextSeq;
+    std::atomic<bool> receiveComplete;
+    uint32_t received;
+    uint8_t fillIndex;
+    bool nackSent;
+
+    // Written by the flashing side only
+    uint16_t ackedSeq;
+    uint32_t written;
+    uint8_t flushIndex;
+
+    uint8_t buffers[2][OTA_BUFFER_SIZE];
+    uint16_t bufferLength[2];
+    std::atomic<bool> bufferReady[2];
+};
+
+void otaSessionInit(OtaSession &session, OtaFlashBackend *backend);
+OtaStatus otaSessionBegin(OtaSession &session, uint32_t imageSize, const uint8_t *expectedHash, uint32_t now);
+OtaStatus otaSessionReceive(OtaSession &session, const uint8_t *data, size_t length);
+OtaStatus otaSessionService(OtaSession &session, uint32_t now);
+void otaSessionAbort(OtaSession &session);
+uint32_t otaSessionThroughput(const OtaSession &session);
+
+#endif
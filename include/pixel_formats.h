@@ -0,0 +1,23 @@
+#ifndef PIXEL_FORMATS_H
+#define PIXEL_FORMATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define PALETTE_MAX_COLORS 256
+
+#define INDEXED_ODD_COUNT 0x80 // Flag on 4 bpp indexed data: the low nibble of the last byte is padding
+
+#define PIXEL_FORMAT_RGB565 0x01   // 2 bytes per pixel, big-endian, W = 0
+#define PIXEL_FORMAT_RGB332 0x02   // 1 byte per pixel, W = 0
+#define PIXEL_FORMAT_RGBW4444 0x03 // 2 bytes per pixel, [R:4 G:4][B:4 W:4]
+
+size_t indexedPixelCount(uint8_t format, size_t length);
+size_t decodeIndexedPixels(uint8_t *frame, size_t framePixels, size_t start,
+                           const uint8_t *data, size_t length, uint8_t format,
+                           const uint8_t (*palette)[4]);
+size_t decodePackedPixels(uint8_t *frame, size_t framePixels, size_t start,
+                          const uint8_t *data, size_t length, uint8_t format);
+size_t packedPixelSize(uint8_t format);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef POWER_BUDGET_H
+#define POWER_BUDGET_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct FrameChannelSums {
+    uint32_t r;
+    uint32_t g;
+    uint32_t b;
+    uint32_t w;
+};
+
+void sumFrameChannels(const uint8_t *frame, size_t pixels, FrameChannelSums &sums);
+uint32_t estimateFrameCurrent(const uint8_t *frame, size_t pixels);
+uint32_t powerBudgetForBattery(int percent);
+uint16_t limitFramePower(uint8_t *frame, size_t pixels, uint32_t budgetMa, uint32_t *estimateMa);
+
+#endif
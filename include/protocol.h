@@ -0,0 +1,82 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define COMMAND_COUNT 0x0B // Highest command ID + 1
+
+enum ParseResult : uint8_t {
+    PARSE_OK = 0,
+    PARSE_EMPTY,
+    PARSE_UNKNOWN_COMMAND,
+    PARSE_INVALID_LENGTH,
+    PARSE_INVALID_VALUE,
+};
+
+struct CommandDescriptor {
+    const char *name;
+    uint16_t minLength;
+    uint16_t maxLength;    // 0 = unbounded
+    uint8_t strideOffset;  // Bytes before the repeated part
+    uint8_t stride;        // 0 = no repeated part
+};
+
+struct ColorCommand {
+    const uint8_t *color;
+};
+
+struct ColorListCommand {
+    const uint8_t *colors;
+    size_t count;
+};
+
+struct SleepTimerCommand {
+    uint16_t minutes;
+};
+
+struct AnimationCommand {
+    uint8_t type;
+    uint8_t speed;
+    const uint8_t *params;
+    size_t paramsLength;
+};
+
+struct TimeSyncCommand {
+    uint32_t sharedMs;
+    int16_t driftPpm;
+    bool hasDrift;
+};
+
+struct PaletteCommand {
+    uint8_t startIndex;
+    const uint8_t *colors;
+    size_t count;
+};
+
+struct PixelDataCommand {
+    uint8_t format; // Bits per pixel (plus INDEXED_ODD_COUNT) for indexed colors, PIXEL_FORMAT_* for packed colors
+    uint16_t start;
+    const uint8_t *data;
+    size_t length;
+};
+
+// Payload pointers reference the input buffer; no data is copied
+struct Command {
+    uint8_t id;
+    uint16_t length;
+    union {
+        ColorCommand color;
+        ColorListCommand colorList;
+        SleepTimerCommand sleepTimer;
+        AnimationCommand animation;
+        TimeSyncCommand timeSync;
+        PaletteCommand palette;
+        PixelDataCommand pixels;
+    };
+};
+
+ParseResult parseCommand(const uint8_t *data, size_t length, Command &command);
+const CommandDescriptor *commandDescriptor(uint8_t id);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef RENDER_TASK_H
+#define RENDER_TASK_H
+
+#include <Arduino.h>
+
+struct RenderStats {
+    uint32_t frames;
+    uint32_t missedDeadlines;
+    uint32_t lastFrameUs;
+    uint32_t maxFrameUs;
+    uint32_t avgFrameUs;
+    uint32_t limitedFrames;
+    uint32_t lastCurrentMa;
+    uint32_t budgetMa;
+    uint32_t droppedFrames;
+    uint16_t frameIntervalMs;
+    uint16_t effectiveFpsX10;
+};
+
+void initRenderTask();
+void stopRenderTask();
+uint8_t *lockFrame();
+void unlockFrame(bool changed);
+void setRenderBatteryPercent(int percent);
+void getRenderStats(RenderStats &stats);
+void publishRenderStats();
+void debugRender();
+
+#endif
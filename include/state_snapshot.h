@@ -0,0 +1,62 @@
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <Arduino.h>
+#include "config.h"
+#include "link_policy.h"
+#include "adv_policy.h"
+#include "render_task.h"
+
+#define SNAPSHOT_VERSION 2
+
+#define SNAPSHOT_FLAG_ANIMATION 0x01
+#define SNAPSHOT_FLAG_SLEEP_TIMER 0x02
+#define SNAPSHOT_FLAG_TIME_SYNCED 0x04
+#define SNAPSHOT_FLAG_FRAME_TRUNCATED 0x08
+
+#define SNAPSHOT_MAX_SIZE 512 // ATT attribute value limit
+
+// Field offsets of the packed snapshot, multi-byte values are big-endian
+enum SnapshotOffset : uint16_t {
+    SNAPSHOT_OFFSET_VERSION = 0,
+    SNAPSHOT_OFFSET_NUM_LEDS = 1,
+    SNAPSHOT_OFFSET_FLAGS = 3,
+    SNAPSHOT_OFFSET_COLOR_COUNT = 4,
+    SNAPSHOT_OFFSET_COLOR_INDEX = 5,
+    SNAPSHOT_OFFSET_COLORS = 6,
+    SNAPSHOT_OFFSET_ANIMATION_TYPE = SNAPSHOT_OFFSET_COLORS + MAX_COLOR_SETS * 4,
+    SNAPSHOT_OFFSET_ANIMATION_SPEED = SNAPSHOT_OFFSET_ANIMATION_TYPE + 1,
+    SNAPSHOT_OFFSET_ANIMATION_PARAMS = SNAPSHOT_OFFSET_ANIMATION_SPEED + 1,
+    SNAPSHOT_OFFSET_TIMER_REMAINING = SNAPSHOT_OFFSET_ANIMATION_PARAMS + 8,
+    SNAPSHOT_OFFSET_BATTERY = SNAPSHOT_OFFSET_TIMER_REMAINING + 4,
+    SNAPSHOT_OFFSET_FIRMWARE = SNAPSHOT_OFFSET_BATTERY + 1,
+    SNAPSHOT_OFFSET_RENDER = SNAPSHOT_OFFSET_FIRMWARE + 8,
+    SNAPSHOT_RENDER_SIZE = 24,
+    SNAPSHOT_OFFSET_FRAME = SNAPSHOT_OFFSET_RENDER + SNAPSHOT_RENDER_SIZE,
+    SNAPSHOT_LINK_SIZE = 13,
+    SNAPSHOT_LINKS_SIZE = BLE_MAX_CONNECTIONS * SNAPSHOT_LINK_SIZE,
+    SNAPSHOT_ADV_SIZE = 12,
+    // Long strips only publish their first LEDs so the value stays within one attribute
+    SNAPSHOT_FRAME_MAX_LEDS = (SNAPSHOT_MAX_SIZE - SNAPSHOT_OFFSET_FRAME - SNAPSHOT_LINKS_SIZE - SNAPSHOT_ADV_SIZE) / 4,
+    SNAPSHOT_FRAME_LEDS = (NUM_LEDS < SNAPSHOT_FRAME_MAX_LEDS) ? NUM_LEDS : SNAPSHOT_FRAME_MAX_LEDS,
+    SNAPSHOT_OFFSET_LINKS = SNAPSHOT_OFFSET_FRAME + SNAPSHOT_FRAME_LEDS * 4,
+    SNAPSHOT_OFFSET_ADV = SNAPSHOT_OFFSET_LINKS + SNAPSHOT_LINKS_SIZE,
+    SNAPSHOT_SIZE = SNAPSHOT_OFFSET_ADV + SNAPSHOT_ADV_SIZE,
+};
+
+static_assert(SNAPSHOT_SIZE <= SNAPSHOT_MAX_SIZE, "State snapshot must fit in one attribute value");
+
+void initStateSnapshot();
+void snapshotSetColors(const uint8_t (*colors)[4], int count, int index);
+void snapshotSetAnimation(uint8_t type, uint8_t speed, const uint8_t *params);
+void snapshotSetSleepTimer(bool active, uint32_t remainingSeconds);
+void snapshotSetTimeSynced(bool synced);
+void snapshotSetBattery(uint8_t percent);
+void snapshotSetRender(const RenderStats &stats);
+void snapshotSetFrame(const uint8_t *frame, bool notify);
+void snapshotSetLink(int slot, const LinkInfo &info);
+void snapshotSetAdvertising(const AdvStats &stats, uint32_t averageTimeToConnectMs);
+bool takeStateSnapshot(uint8_t *out);
+void readStateSnapshot(uint8_t *out);
+
+#endif
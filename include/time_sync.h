@@ -0,0 +1,18 @@
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <stdint.h>
+
+struct TimeSync {
+    bool valid;
+    uint32_t localAnchor;
+    uint32_t sharedAnchor;
+    int32_t driftPpm;
+};
+
+void timeSyncInit(TimeSync &sync);
+void timeSyncApply(TimeSync &sync, uint32_t localNow, uint32_t sharedNow, int32_t driftPpm);
+void timeSyncApplyEstimate(TimeSync &sync, uint32_t localNow, uint32_t sharedNow);
+uint32_t timeSyncNow(const TimeSync &sync, uint32_t localNow);
+
+#endif
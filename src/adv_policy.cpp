@@ -0,0 +1,73 @@
+#include "adv_policy.h"
+#include <string.h>
+
+static void enterMode(AdvPolicy &policy, AdvMode mode, uint32_t now)
+{
+    if (policy.mode == ADV_MODE_OFF && mode != ADV_MODE_OFF) {
+        policy.advertisingStart = now;
+    }
+    policy.mode = mode;
+    policy.modeStart = now;
+}
+
+void advPolicyInit(AdvPolicy &policy, uint8_t maxConnections, uint32_t fastBurstMs, uint32_t now)
+{
+    memset(&policy, 0, sizeof(policy));
+    policy.maxConnections = (maxConnections > 0) ? maxConnections : 1;
+    policy.fastBurstMs = fastBurstMs;
+    policy.stats.minTimeToConnectMs = UINT32_MAX;
+    enterMode(policy, ADV_MODE_FAST, now);
+}
+
+void advPolicyOnConnect(AdvPolicy &policy, uint32_t now)
+{
+    if (policy.mode != ADV_MODE_OFF) {
+        uint32_t timeToConnect = now - policy.advertisingStart;
+        AdvStats &stats = policy.stats;
+
+        stats.connects++;
+        if (policy.mode == ADV_MODE_FAST) {
+            stats.fastConnects++;
+        } else {
+            stats.slowConnects++;
+        }
+        stats.lastTimeToConnectMs = timeToConnect;
+        stats.totalTimeToConnectMs += timeToConnect;
+        if (timeToConnect < stats.minTimeToConnectMs) stats.minTimeToConnectMs = timeToConnect;
+        if (timeToConnect > stats.maxTimeToConnectMs) stats.maxTimeToConnectMs = timeToConnect;
+    }
+
+    if (policy.connections < UINT8_MAX) {
+        policy.connections++;
+    }
+
+    // The controller stops advertising once a link is up; free slots are offered at the slow rate
+    policy.mode = ADV_MODE_OFF;
+    if (policy.connections < policy.maxConnections) {
+        enterMode(policy, ADV_MODE_SLOW, now);
+    }
+}
+
+void advPolicyOnDisconnect(AdvPolicy &policy, uint32_t now)
+{
+    if (policy.connections > 0) {
+        policy.connections--;
+    }
+    enterMode(policy, ADV_MODE_FAST, now);
+}
+
+AdvMode advPolicyUpdate(AdvPolicy &policy, uint32_t now)
+{
+    if (policy.mode == ADV_MODE_FAST && (now - policy.modeStart) >= policy.fastBurstMs) {
+        enterMode(policy, ADV_MODE_SLOW, now);
+    }
+    return policy.mode;
+}
+
+uint32_t advPolicyAverageTimeToConnect(const AdvPolicy &policy)
+{
+    if (policy.stats.connects == 0) {
+        return 0;
+    }
+    return (uint32_t)(policy.stats.totalTimeToConnectMs / policy.stats.connects);
+}
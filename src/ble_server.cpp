@@ -2,10 +2,18 @@
 #include "led_control.h"
 #include "button_handler.h"
 #include "config.h"
+#include "adv_policy.h"
+#include "ota_service.h"
+#include "render_task.h"
+#include "pixel_formats.h"
+#include "protocol.h"
+#include "state_snapshot.h"
+#include "link_policy.h"
 #include <NimBLEDevice.h>
 
 NimBLEServer *pServer = nullptr;
 NimBLECharacteristic *lightCharacteristic;
+NimBLECharacteristic *stateCharacteristic;
 NimBLECharacteristic *batteryCharacteristic;
 NimBLECharacteristic *firmwareCharacteristic;
 
@@ -32,110 +40,307 @@ int batteryPercent(float v) {
 bool deviceConnected = false;
 uint8_t batteryLevel = 0; // Simulated battery percentage (0-100%)
 
+// Advertising policy state, shared between the NimBLE host task and loop()
+portMUX_TYPE advMux = portMUX_INITIALIZER_UNLOCKED;
+AdvPolicy advPolicy;
+uint32_t advEvents = 0;
+AdvMode advAppliedMode = ADV_MODE_OFF;
+uint32_t advAppliedEvents = 0;
+unsigned long advLastAttempt = 0;
+uint32_t advReportedConnects = 0;
+
+// Per-connection state. Palettes are only touched from the NimBLE host task,
+// connection handles and link fields are shared with loop() under linkMux.
+struct ConnectionState {
+    uint16_t connHandle;
+    bool hasPalette;
+    uint8_t palette[PALETTE_MAX_COLORS][4];
+    LinkPolicy link;
+    LinkInfo info;
+    bool linkApplied;
+    LinkWorkload appliedWorkload;
+};
+portMUX_TYPE linkMux = portMUX_INITIALIZER_UNLOCKED;
+ConnectionState connections[BLE_MAX_CONNECTIONS];
+
+static ConnectionState *findConnection(uint16_t connHandle)
+{
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        if (connections[i].connHandle == connHandle) {
+            return &connections[i];
+        }
+    }
+    return nullptr;
+}
+
+static void publishLinkInfo(int slot)
+{
+    portENTER_CRITICAL(&linkMux);
+    LinkInfo info = connections[slot].info;
+    portEXIT_CRITICAL(&linkMux);
+    snapshotSetLink(slot, info);
+}
+
+static void logLinkInfo(const LinkInfo &info)
+{
+    Serial.print("🔗 Link ");
+    Serial.print(info.connHandle);
+    Serial.print(": interval ");
+    Serial.print(info.interval * 1.25, 2);
+    Serial.print(" ms, latency ");
+    Serial.print(info.latency);
+    Serial.print(", timeout ");
+    Serial.print(info.timeout * 10);
+    Serial.print(" ms, PHY ");
+    Serial.print(info.txPhy);
+    Serial.print("/");
+    Serial.print(info.rxPhy);
+    Serial.print(", MTU ");
+    Serial.println(info.mtu);
+}
+
+static void updateLinkInfo(NimBLEConnInfo &connInfo, uint8_t txPhy, uint8_t rxPhy, uint16_t mtu, bool paramsUpdate)
+{
+    ConnectionState *connection = nullptr;
+    LinkInfo info;
+    bool outsideRequest = false;
+
+    portENTER_CRITICAL(&linkMux);
+    connection = findConnection(connInfo.getConnHandle());
+    if (connection != nullptr) {
+        if (paramsUpdate && connection->linkApplied) {
+            const LinkParams &params = linkParamsFor(connection->appliedWorkload);
+            uint16_t interval = connInfo.getConnInterval();
+            outsideRequest = interval < params.minInterval || interval > params.maxInterval;
+        }
+        connection->info.interval = connInfo.getConnInterval();
+        connection->info.latency = connInfo.getConnLatency();
+        connection->info.timeout = connInfo.getConnTimeout();
+        if (txPhy != 0) connection->info.txPhy = txPhy;
+        if (rxPhy != 0) connection->info.rxPhy = rxPhy;
+        if (mtu != 0) connection->info.mtu = mtu;
+        info = connection->info;
+    }
+    portEXIT_CRITICAL(&linkMux);
+
+    if (connection != nullptr) {
+        publishLinkInfo(connection - connections);
+        logLinkInfo(info);
+        if (outsideRequest) {
+            Serial.println("⚠️ Central chose an interval outside the requested range");
+        }
+    }
+}
+
+void noteLinkWrite(uint16_t connHandle, size_t length, bool bulk)
+{
+    portENTER_CRITICAL(&linkMux);
+    ConnectionState *connection = findConnection(connHandle);
+    if (connection != nullptr) {
+        linkPolicyOnWrite(connection->link, bulk, millis());
+        connection->info.bytesWritten += length;
+    }
+    portEXIT_CRITICAL(&linkMux);
+}
+
 class MyServerCallbacks : public NimBLEServerCallbacks
 {
     void onConnect(NimBLEServer *pServer, NimBLEConnInfo &connInfo) override
     {
-        deviceConnected = true;
+        portENTER_CRITICAL(&linkMux);
+        ConnectionState *connection = findConnection(BLE_HS_CONN_HANDLE_NONE);
+        if (connection != nullptr) {
+            connection->connHandle = connInfo.getConnHandle();
+            connection->hasPalette = false;
+            linkPolicyInit(connection->link, millis());
+            connection->info = {connInfo.getConnHandle(), connInfo.getConnInterval(), connInfo.getConnLatency(),
+                                connInfo.getConnTimeout(), 1, 1, connInfo.getMTU(), LINK_IDLE, 0};
+            connection->linkApplied = false;
+        }
+        portEXIT_CRITICAL(&linkMux);
+
+        portENTER_CRITICAL(&advMux);
+        advPolicyOnConnect(advPolicy, millis());
+        advEvents++;
+        deviceConnected = advPolicy.connections > 0;
+        portEXIT_CRITICAL(&advMux);
+
         Serial.println("📱 Device connected");
     }
 
     void onDisconnect(NimBLEServer *pServer, NimBLEConnInfo &connInfo, int reason) override
     {
-        deviceConnected = false;
+        portENTER_CRITICAL(&linkMux);
+        ConnectionState *connection = findConnection(connInfo.getConnHandle());
+        int slot = -1;
+        if (connection != nullptr) {
+            connection->connHandle = BLE_HS_CONN_HANDLE_NONE;
+            connection->info.connHandle = BLE_HS_CONN_HANDLE_NONE;
+            slot = connection - connections;
+        }
+        portEXIT_CRITICAL(&linkMux);
+        if (slot >= 0) {
+            publishLinkInfo(slot);
+        }
+
+        portENTER_CRITICAL(&advMux);
+        advPolicyOnDisconnect(advPolicy, millis());
+        advEvents++;
+        deviceConnected = advPolicy.connections > 0;
+        portEXIT_CRITICAL(&advMux);
+
         Serial.print("🔌 Device disconnected (reason: ");
         Serial.print(reason);
         Serial.println(")");
-        
-        delay(500);
-        
-        NimBLEAdvertising *pAdvertising = NimBLEDevice::getAdvertising();
-        if (pAdvertising != nullptr && !pAdvertising->isAdvertising()) {
-            pAdvertising->start(0, 0);
-            Serial.println("✅ Advertising restarted - device available for connection");
-        }
+    }
+
+    void onMTUChange(uint16_t MTU, NimBLEConnInfo &connInfo) override
+    {
+        updateLinkInfo(connInfo, 0, 0, MTU, false);
+    }
+
+    void onConnParamsUpdate(NimBLEConnInfo &connInfo) override
+    {
+        updateLinkInfo(connInfo, 0, 0, 0, true);
+    }
+
+    void onPhyUpdate(NimBLEConnInfo &connInfo, uint8_t txPhy, uint8_t rxPhy) override
+    {
+        updateLinkInfo(connInfo, txPhy, rxPhy, 0, false);
     }
 };
 
-class LightCharacteristicCallbacks : public NimBLECharacteristicCallbacks
+typedef void (*CommandHandler)(const Command &command, NimBLEConnInfo &connInfo);
+
+static void handleSetColor(const Command &command, NimBLEConnInfo &connInfo)
 {
-    void onWrite(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo) override
-    {
-        Serial.println("📩 BLE Write Received!");
+    setColorFromBytes(command.color.color);
+}
 
-        std::string receivedData = pCharacteristic->getValue();
-        size_t length = receivedData.length();
+static void handleSetColorSets(const Command &command, NimBLEConnInfo &connInfo)
+{
+    updateColorSets(command.colorList.colors, command.colorList.count * 4);
+}
 
-        Serial.print("📥 Received Data: ");
-        Serial.println(receivedData.c_str());
+static void handleDisableBLE(const Command &command, NimBLEConnInfo &connInfo)
+{
+    Serial.println("🔌 CMD_DISABLE_BLE received - Going to deep sleep...");
+    goToDeepSleep();
+}
 
-        if (receivedData.empty())
-            return;
+static void handleSetIndividualColors(const Command &command, NimBLEConnInfo &connInfo)
+{
+    setIndividualLEDColors(command.colorList.colors, command.colorList.count);
+}
 
-        uint8_t command = receivedData[0];
+static void handleSetSleepTimer(const Command &command, NimBLEConnInfo &connInfo)
+{
+    setSleepTimer(command.sleepTimer.minutes);
+}
 
-        switch (command)
-        {
-        case CMD_SET_COLOR:
-            if (length == 5) {
-                setColorFromBytes((uint8_t *)&receivedData[1]);
-            } else {
-                Serial.print("❌ Invalid CMD_SET_COLOR length: ");
-                Serial.println(length);
-            }
-            break;
+static void handleSetAnimation(const Command &command, NimBLEConnInfo &connInfo)
+{
+    const AnimationCommand &animation = command.animation;
+    setAnimation(animation.type, animation.speed, animation.params, animation.paramsLength);
+}
 
-        case CMD_SET_COLOR_SETS:
-            if (length >= 5 && (length - 1) % 4 == 0)
-            {
-                updateColorSets((uint8_t *)&receivedData[1], length - 1);
-            } else {
-                Serial.print("❌ Invalid CMD_SET_COLOR_SETS length: ");
-                Serial.println(length);
-            }
-            break;
+static void handleSetTimeSync(const Command &command, NimBLEConnInfo &connInfo)
+{
+    const TimeSyncCommand &timeSync = command.timeSync;
+    setTimeSync(timeSync.sharedMs, timeSync.driftPpm, !timeSync.hasDrift);
+}
+
+static void handleSetPalette(const Command &command, NimBLEConnInfo &connInfo)
+{
+    ConnectionState *connection = findConnection(connInfo.getConnHandle());
+    if (connection == nullptr) {
+        Serial.println("❌ No connection slot for palette");
+        return;
+    }
+    if (!connection->hasPalette) {
+        memset(connection->palette, 0, sizeof(connection->palette));
+        connection->hasPalette = true;
+    }
+    memcpy(connection->palette[command.palette.startIndex], command.palette.colors, command.palette.count * 4);
+}
 
-        case CMD_DISABLE_BLE:
-            Serial.println("🔌 CMD_DISABLE_BLE received - Going to deep sleep...");
-            goToDeepSleep();
+static void handleSetIndexedColors(const Command &command, NimBLEConnInfo &connInfo)
+{
+    ConnectionState *connection = findConnection(connInfo.getConnHandle());
+    if (connection == nullptr || !connection->hasPalette) {
+        Serial.println("❌ CMD_SET_INDEXED_COLORS without palette");
+        return;
+    }
+    const PixelDataCommand &pixels = command.pixels;
+    setIndexedLEDColors(pixels.start, pixels.data, pixels.length, pixels.format, connection->palette);
+}
+
+static void handleSetPackedColors(const Command &command, NimBLEConnInfo &connInfo)
+{
+    const PixelDataCommand &pixels = command.pixels;
+    setPackedLEDColors(pixels.start, pixels.data, pixels.length, pixels.format);
+}
+
+static const CommandHandler commandHandlers[COMMAND_COUNT] = {
+    nullptr,
+    handleSetColor,
+    handleSetColorSets,
+    handleDisableBLE,
+    handleSetIndividualColors,
+    handleSetSleepTimer,
+    handleSetAnimation,
+    handleSetTimeSync,
+    handleSetPalette,
+    handleSetIndexedColors,
+    handleSetPackedColors,
+};
+
+// Reads return the live snapshot, including animated frames that are not notified
+class StateCharacteristicCallbacks : public NimBLECharacteristicCallbacks
+{
+    void onRead(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo) override
+    {
+        uint8_t state[SNAPSHOT_SIZE];
+        readStateSnapshot(state);
+        pCharacteristic->setValue(state, SNAPSHOT_SIZE);
+    }
+};
+
+class LightCharacteristicCallbacks : public NimBLECharacteristicCallbacks
+{
+    void onWrite(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo) override
+    {
+        const NimBLEAttValue &value = pCharacteristic->getValue();
+        noteLinkWrite(connInfo.getConnHandle(), value.size(), false);
+
+        Command command;
+        ParseResult result = parseCommand(value.data(), value.size(), command);
+
+        switch (result)
+        {
+        case PARSE_OK:
+            commandHandlers[command.id](command, connInfo);
             break;
 
-        case CMD_SET_INDIVIDUAL_COLORS:
-            if (length >= 5 && (length - 1) % 4 == 0) {
-                size_t numLEDs = (length - 1) / 4;
-                setIndividualLEDColors((uint8_t *)&receivedData[1], numLEDs);
-            } else {
-                Serial.print("❌ Invalid CMD_SET_INDIVIDUAL_COLORS length: ");
-                Serial.println(length);
-            }
+        case PARSE_EMPTY:
             break;
 
-        case CMD_SET_SLEEP_TIMER:
-            if (length == 3) {
-                uint16_t minutes = (receivedData[1] << 8) | receivedData[2];
-                setSleepTimer(minutes);
-            } else {
-                Serial.print("❌ Invalid CMD_SET_SLEEP_TIMER length: ");
-                Serial.println(length);
-            }
+        case PARSE_UNKNOWN_COMMAND:
+            Serial.print("❌ Unknown command: 0x");
+            Serial.println(command.id, HEX);
             break;
 
-        case CMD_SET_ANIMATION:
-            if (length >= 3) {
-                uint8_t animType = receivedData[1];
-                uint8_t speed = receivedData[2];
-                uint8_t *params = (length > 3) ? (uint8_t *)&receivedData[3] : nullptr;
-                size_t paramsLength = (length > 3) ? (length - 3) : 0;
-                setAnimation(animType, speed, params, paramsLength);
-            } else {
-                Serial.print("❌ Invalid CMD_SET_ANIMATION length: ");
-                Serial.println(length);
-            }
+        case PARSE_INVALID_LENGTH:
+            Serial.print("❌ Invalid ");
+            Serial.print(commandDescriptor(command.id)->name);
+            Serial.print(" length: ");
+            Serial.println(command.length);
             break;
 
-        default:
-            Serial.print("❌ Unknown command: 0x");
-            Serial.println(command, HEX);
+        case PARSE_INVALID_VALUE:
+            Serial.print("❌ Invalid ");
+            Serial.print(commandDescriptor(command.id)->name);
+            Serial.println(" parameters");
             break;
         }
     }
@@ -145,24 +350,39 @@ void initBLE()
 {
     if (!NimBLEDevice::init(DEVICE_NAME)) {
         Serial.println("❌ Failed to initialize BLE");
+        rejectOTABoot();
         return;
     }
     
     NimBLEDevice::setPower(ESP_PWR_LVL_N0);
+    NimBLEDevice::setMTU(LINK_PREFERRED_MTU);
 
     pServer = NimBLEDevice::createServer();
     if (pServer == nullptr) {
         Serial.println("❌ Failed to create BLE server");
+        rejectOTABoot();
         return;
     }
     
     pServer->setCallbacks(new MyServerCallbacks());
+    pServer->advertiseOnDisconnect(false);
+
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        connections[i].connHandle = BLE_HS_CONN_HANDLE_NONE;
+        connections[i].info.connHandle = BLE_HS_CONN_HANDLE_NONE;
+        publishLinkInfo(i);
+    }
 
     NimBLEService *lightService = pServer->createService(LIGHT_SERVICE_UUID);
     lightCharacteristic = lightService->createCharacteristic(
         LIGHT_CHARACTERISTIC_UUID,
         NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR | NIMBLE_PROPERTY::READ);
     lightCharacteristic->setCallbacks(new LightCharacteristicCallbacks());
+    stateCharacteristic = lightService->createCharacteristic(
+        STATE_CHARACTERISTIC_UUID,
+        NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::NOTIFY);
+    stateCharacteristic->setCallbacks(new StateCharacteristicCallbacks());
+    updateStateBLE();
     lightService->start();
 
     NimBLEService *batteryService = pServer->createService(BATTERY_SERVICE_UUID);
@@ -178,13 +398,23 @@ void initBLE()
         NIMBLE_PROPERTY::READ);
     firmwareCharacteristic->setValue(FIRMWARE_VERSION);
     deviceInfoService->start();
+
+    initOTAService(pServer);
+
     NimBLEAdvertising *pAdvertising = NimBLEDevice::getAdvertising();
     pAdvertising->setName(DEVICE_NAME);
     pAdvertising->addServiceUUID(lightService->getUUID());
     pAdvertising->addServiceUUID(batteryService->getUUID());
     pAdvertising->addServiceUUID(deviceInfoService->getUUID());
     pAdvertising->enableScanResponse(true);
-    pAdvertising->start(0, 0);
+
+    portENTER_CRITICAL(&advMux);
+    advPolicyInit(advPolicy, BLE_MAX_CONNECTIONS, ADV_FAST_BURST_MS, millis());
+    advEvents++;
+    portEXIT_CRITICAL(&advMux);
+    ensureBLEAdvertising();
+
+    confirmOTABoot();
 }
 
 void debugScan()
@@ -250,6 +480,40 @@ void debugBLE()
         Serial.println("🛑 No BLE Connections");
     }
 
+    portENTER_CRITICAL(&advMux);
+    AdvStats stats = advPolicy.stats;
+    uint32_t averageTimeToConnect = advPolicyAverageTimeToConnect(advPolicy);
+    portEXIT_CRITICAL(&advMux);
+
+    Serial.print("⏱️ Connects: ");
+    Serial.print(stats.connects);
+    Serial.print(" (fast ");
+    Serial.print(stats.fastConnects);
+    Serial.print(", slow ");
+    Serial.print(stats.slowConnects);
+    Serial.print("), time-to-connect last/min/avg/max: ");
+    Serial.print(stats.lastTimeToConnectMs);
+    Serial.print("/");
+    Serial.print(stats.connects > 0 ? stats.minTimeToConnectMs : 0);
+    Serial.print("/");
+    Serial.print(averageTimeToConnect);
+    Serial.print("/");
+    Serial.print(stats.maxTimeToConnectMs);
+    Serial.println(" ms");
+
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        portENTER_CRITICAL(&linkMux);
+        LinkInfo info = connections[i].info;
+        portEXIT_CRITICAL(&linkMux);
+        if (info.connHandle != BLE_HS_CONN_HANDLE_NONE) {
+            logLinkInfo(info);
+            Serial.print("   workload ");
+            Serial.print(info.workload);
+            Serial.print(", bytes written ");
+            Serial.println(info.bytesWritten);
+        }
+    }
+
     debugScan();
 }
 
@@ -258,12 +522,15 @@ void disableBLE()
     Serial.println("🔌 Disabling BLE Server...");
     pServer->getAdvertising()->stop();
     NimBLEDevice::deinit(true);
+    pServer = nullptr;
 }
 
 void updateBatteryLevelBLE()
 {
     float voltage = readBatteryVoltage();
     batteryLevel = batteryPercent(voltage);
+    setRenderBatteryPercent(batteryLevel);
+    snapshotSetBattery(batteryLevel);
 
     Serial.print("🔋 Battery: ");
     Serial.print(voltage, 3);
@@ -282,17 +549,166 @@ void updateBatteryLevelBLE()
     }
 }
 
+static bool applyAdvertisingMode(AdvMode mode)
+{
+    NimBLEAdvertising *pAdvertising = NimBLEDevice::getAdvertising();
+    if (pAdvertising == nullptr) {
+        return false;
+    }
+
+    if (pAdvertising->isAdvertising()) {
+        pAdvertising->stop();
+    }
+
+    if (mode == ADV_MODE_OFF) {
+        return true;
+    }
+
+    if (mode == ADV_MODE_FAST) {
+        pAdvertising->setMinInterval(ADV_FAST_INTERVAL_MIN);
+        pAdvertising->setMaxInterval(ADV_FAST_INTERVAL_MAX);
+    } else {
+        pAdvertising->setMinInterval(ADV_SLOW_INTERVAL_MIN);
+        pAdvertising->setMaxInterval(ADV_SLOW_INTERVAL_MAX);
+    }
+
+    return pAdvertising->start(0);
+}
+
 void ensureBLEAdvertising()
 {
     if (pServer == nullptr) {
         return;
     }
-    
-    if (pServer->getConnectedCount() == 0) {
-        NimBLEAdvertising *pAdvertising = NimBLEDevice::getAdvertising();
-        if (pAdvertising != nullptr && !pAdvertising->isAdvertising()) {
-            pAdvertising->start(0, 0);
-            Serial.println("✅ Advertising restarted - device available");
+
+    unsigned long now = millis();
+
+    portENTER_CRITICAL(&advMux);
+    AdvMode mode = advPolicyUpdate(advPolicy, now);
+    uint32_t events = advEvents;
+    bool upToDate = (mode == advAppliedMode) && (events == advAppliedEvents);
+    AdvStats stats = advPolicy.stats;
+    uint32_t averageTimeToConnect = advPolicyAverageTimeToConnect(advPolicy);
+    portEXIT_CRITICAL(&advMux);
+
+    if (stats.connects != advReportedConnects) {
+        advReportedConnects = stats.connects;
+        snapshotSetAdvertising(stats, averageTimeToConnect);
+        Serial.print("⏱️ Time to connect: ");
+        Serial.print(stats.lastTimeToConnectMs);
+        Serial.println(" ms");
+    }
+
+    if (upToDate) {
+        return;
+    }
+
+    if (mode != ADV_MODE_OFF && advLastAttempt != 0 && now - advLastAttempt < ADV_RETRY_DELAY_MS) {
+        return;
+    }
+    advLastAttempt = now;
+
+    if (!applyAdvertisingMode(mode)) {
+        Serial.println("❌ Failed to start advertising");
+        return;
+    }
+    advLastAttempt = 0;
+
+    // Connection events that land while the controller is reconfigured trigger another pass
+    portENTER_CRITICAL(&advMux);
+    advAppliedMode = mode;
+    advAppliedEvents = events;
+    portEXIT_CRITICAL(&advMux);
+
+    if (mode == ADV_MODE_FAST) {
+        Serial.println("✅ Fast advertising - device available for connection");
+    } else if (mode == ADV_MODE_SLOW) {
+        Serial.println("📡 Slow advertising - idle");
+    }
+}
+
+void updateStateBLE()
+{
+    static unsigned long lastPublish = 0;
+    static bool published = false;
+
+    if (stateCharacteristic == nullptr) {
+        return;
+    }
+
+    if (published && millis() - lastPublish < STATE_PUBLISH_INTERVAL_MS) {
+        return;
+    }
+
+    uint8_t state[SNAPSHOT_SIZE];
+    if (!takeStateSnapshot(state)) {
+        return;
+    }
+
+    stateCharacteristic->setValue(state, SNAPSHOT_SIZE);
+    if (deviceConnected) {
+        stateCharacteristic->notify();
+    }
+    lastPublish = millis();
+    published = true;
+}
+
+void updateLinkPolicy()
+{
+    if (pServer == nullptr) {
+        return;
+    }
+
+    for (int i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        portENTER_CRITICAL(&linkMux);
+        ConnectionState &connection = connections[i];
+        uint16_t connHandle = connection.connHandle;
+        bool firstApply = !connection.linkApplied;
+        bool needsApply = false;
+        LinkWorkload workload = LINK_IDLE;
+        bool phy2M = false;
+        if (connHandle != BLE_HS_CONN_HANDLE_NONE) {
+            linkPolicyUpdate(connection.link, millis());
+            workload = connection.link.workload;
+            needsApply = firstApply || connection.appliedWorkload != workload;
+            phy2M = connection.info.txPhy == 2 && connection.info.rxPhy == 2;
+        }
+        portEXIT_CRITICAL(&linkMux);
+
+        if (!needsApply) {
+            continue;
+        }
+
+        const LinkParams &params = linkParamsFor(workload);
+        if (!pServer->updateConnParams(connHandle, params.minInterval, params.maxInterval, params.latency, params.timeout)) {
+            Serial.print("❌ Connection parameter request failed on link ");
+            Serial.println(connHandle);
+        }
+        if (firstApply && !pServer->setDataLen(connHandle, LINK_DATA_LENGTH)) {
+            Serial.print("❌ Data length request failed on link ");
+            Serial.println(connHandle);
+        }
+        if (params.phy2M && !phy2M && !pServer->updatePhy(connHandle, BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_2M_MASK, 0)) {
+            Serial.print("❌ 2M PHY request failed on link ");
+            Serial.println(connHandle);
+        }
+
+        portENTER_CRITICAL(&linkMux);
+        if (connection.connHandle == connHandle) {
+            connection.linkApplied = true;
+            connection.appliedWorkload = workload;
+            connection.info.workload = workload;
         }
+        portEXIT_CRITICAL(&linkMux);
+        publishLinkInfo(i);
+
+        Serial.print("🔗 Link ");
+        Serial.print(connHandle);
+        Serial.print(workload == LINK_IDLE ? ": idle" : (workload == LINK_BULK ? ": bulk" : ": streaming"));
+        Serial.print(" parameters requested (");
+        Serial.print(params.minInterval * 1.25, 2);
+        Serial.print("-");
+        Serial.print(params.maxInterval * 1.25, 2);
+        Serial.println(" ms)");
     }
 }
@@ -1,6 +1,7 @@
 #include "button_handler.h"
 #include "config.h"
 #include "led_control.h"
+#include "render_task.h"
 #include <Arduino.h>
 #include <esp_sleep.h>
 
@@ -31,6 +32,8 @@ void goToDeepSleep()
     detachInterrupt(BUTTON_PIN);
 
     // Turn off all LEDs before sleep to prevent electrical noise from triggering wake-ups
+    // The render task is stopped first so a running animation cannot repaint the strip
+    stopRenderTask();
     turnOffLEDs();
     delay(100);
 
@@ -0,0 +1,72 @@
+#include "frame_governor.h"
+#include "config.h"
+
+void frameGovernorInit(FrameGovernor &governor, uint32_t now)
+{
+    governor.intervalMs = FRAME_INTERVAL_MIN_MS;
+    governor.lastRenderMs = now;
+    governor.rendered = 0;
+    governor.shown = 0;
+    governor.dropped = 0;
+    governor.windowStartMs = now;
+    governor.windowShown = 0;
+    governor.effectiveFpsX10 = 0;
+}
+
+bool frameGovernorDue(const FrameGovernor &governor, uint32_t now)
+{
+    return (now - governor.lastRenderMs) >= governor.intervalMs;
+}
+
+uint8_t frameDelta(const uint8_t *current, const uint8_t *previous, size_t length)
+{
+    uint8_t maxDelta = 0;
+    for (size_t i = 0; i < length; i++) {
+        uint8_t delta = (current[i] > previous[i]) ? current[i] - previous[i] : previous[i] - current[i];
+        if (delta > maxDelta) {
+            maxDelta = delta;
+        }
+    }
+    return maxDelta;
+}
+
+void frameGovernorUpdate(FrameGovernor &governor, uint8_t delta, bool shown, int batteryPercent, uint32_t now)
+{
+    governor.lastRenderMs = now;
+    governor.rendered++;
+    if (shown) {
+        governor.shown++;
+        governor.windowShown++;
+    } else {
+        governor.dropped++;
+    }
+
+    uint16_t minInterval = (batteryPercent <= GOVERNOR_LOW_BATTERY_PERCENT) ? FRAME_INTERVAL_LOW_BATTERY_MS : FRAME_INTERVAL_MIN_MS;
+    uint32_t interval = governor.intervalMs;
+
+    // Aim for a few levels of change per shown frame: halve quickly on motion, back off gently
+    if (delta > FRAME_DELTA_HIGH) {
+        interval /= 2;
+    } else if (delta < FRAME_DELTA_LOW) {
+        interval = interval * 5 / 4 + 1;
+    }
+
+    if (interval < minInterval) interval = minInterval;
+    if (interval > FRAME_INTERVAL_MAX_MS) interval = FRAME_INTERVAL_MAX_MS;
+    governor.intervalMs = interval;
+
+    uint32_t windowMs = now - governor.windowStartMs;
+    if (windowMs >= 1000) {
+        governor.effectiveFpsX10 = governor.windowShown * 10000 / windowMs;
+        governor.windowShown = 0;
+        governor.windowStartMs = now;
+    }
+}
+
+// No animation: report 0 fps and start a fresh window for the next one
+void frameGovernorIdle(FrameGovernor &governor, uint32_t now)
+{
+    governor.windowStartMs = now;
+    governor.windowShown = 0;
+    governor.effectiveFpsX10 = 0;
+}
@@ -1,23 +1,29 @@
 #include "led_control.h"
 #include "config.h"
+#include "time_sync.h"
+#include "render_task.h"
+#include "pixel_formats.h"
+#include "state_snapshot.h"
 #include <Preferences.h>
 #include <math.h>
 
-Adafruit_NeoPixel strip(NUM_LEDS, LED_PIN, NEO_GRBW + NEO_KHZ800);
 Preferences preferences;
 
 uint8_t storedColors[MAX_COLOR_SETS][4];
 int storedColorCount = 0;
 int colorSetIndex = 0;
 
-// Animation state
+// Animation state; the stored colors above are covered too since the render task reads them
+portMUX_TYPE animationMux = portMUX_INITIALIZER_UNLOCKED;  // BLE writers vs render task
 uint8_t animationType = 0;
 uint8_t animationSpeed = 50;
-unsigned long animationLastUpdate = 0;
-uint32_t animationStep = 0;
 uint8_t animationColors[2][4] = {{255, 0, 0, 0}, {0, 0, 255, 0}};
 uint8_t animationParams[8] = {0};
 
+// Shared time base for animation phase, written from the BLE host task
+portMUX_TYPE timeSyncMux = portMUX_INITIALIZER_UNLOCKED;
+TimeSync timeSync = {false, 0, 0, 0};
+
 // Sleep timer state
 unsigned long sleepTimerStart = 0;
 uint16_t sleepTimerMinutes = 0;
@@ -32,12 +38,54 @@ static void initDefaultColors()
     storedColors[3][0] = 0;   storedColors[3][1] = 0;   storedColors[3][2] = 0;   storedColors[3][3] = 255;
 }
 
+static void publishColorState()
+{
+    uint8_t colors[MAX_COLOR_SETS][4];
+    portENTER_CRITICAL(&animationMux);
+    memcpy(colors, storedColors, sizeof(colors));
+    int count = storedColorCount;
+    portEXIT_CRITICAL(&animationMux);
+    snapshotSetColors(colors, count, colorSetIndex);
+}
+
+static void publishAnimationState()
+{
+    uint8_t params[8];
+    portENTER_CRITICAL(&animationMux);
+    uint8_t type = animationType;
+    uint8_t speed = animationSpeed;
+    memcpy(params, animationParams, sizeof(params));
+    portEXIT_CRITICAL(&animationMux);
+    snapshotSetAnimation(type, speed, params);
+}
+
+static void stopAnimation()
+{
+    portENTER_CRITICAL(&animationMux);
+    animationType = 0;
+    portEXIT_CRITICAL(&animationMux);
+    publishAnimationState();
+}
+
+static void fillFrame(uint8_t r, uint8_t g, uint8_t b, uint8_t w)
+{
+    uint8_t *frame = lockFrame();
+    for (int i = 0; i < NUM_LEDS; i++) {
+        frame[i * 4 + 0] = r;
+        frame[i * 4 + 1] = g;
+        frame[i * 4 + 2] = b;
+        frame[i * 4 + 3] = w;
+    }
+    unlockFrame(true);
+}
+
 void initLEDs()
 {
-    strip.setPin(LED_PIN);
-    strip.begin();
+    initStateSnapshot();
     loadStoredColors();
-    strip.show();
+    publishColorState();
+    publishAnimationState();
+    initRenderTask();
 }
 
 void loadStoredColors()
@@ -102,8 +150,11 @@ void updateColorSets(const uint8_t *colorData, size_t length)
         return;
     }
 
-    memcpy(storedColors, colorData, length); 
+    portENTER_CRITICAL(&animationMux);
+    memcpy(storedColors, colorData, length);
     storedColorCount = length / 4;
+    portEXIT_CRITICAL(&animationMux);
+    publishColorState();
 
     saveColorSets(colorData, length);
 }
@@ -111,10 +162,7 @@ void updateColorSets(const uint8_t *colorData, size_t length)
 void turnOffLEDs() {
     Serial.println("Turning off LEDs.");
 
-    for (int i = 0; i < NUM_LEDS; i++) {
-        strip.setPixelColor(i, strip.Color(0, 0, 0, 0));
-    }
-    strip.show();
+    fillFrame(0, 0, 0, 0);
 }
 
 void switchToNextColor() {
@@ -129,6 +177,7 @@ void switchToNextColor() {
         turnOffLEDs();
         colorSetIndex = 0;
     }
+    publishColorState();
 }
 
 
@@ -141,16 +190,7 @@ void setColorFromBytes(const uint8_t *colorData)
 
     Serial.println("Setting LED color...");
 
-    uint8_t r = colorData[0];
-    uint8_t g = colorData[1];
-    uint8_t b = colorData[2];
-    uint8_t w = colorData[3];
-
-    for (int i = 0; i < NUM_LEDS; i++)
-    {
-        strip.setPixelColor(i, strip.Color(r, g, b, w));
-    }
-    strip.show();
+    fillFrame(colorData[0], colorData[1], colorData[2], colorData[3]);
 }
 
 void flashAllColorsAnimation(unsigned int delayMs)
@@ -161,6 +201,9 @@ void flashAllColorsAnimation(unsigned int delayMs)
         Serial.println("⚠️ No colors to flash");
         return;
     }
+
+    // The render task keeps animating while this blocks, so a running animation would paint over the flash
+    stopAnimation();
     
     for (int cycle = 0; cycle < 2; cycle++) {
         for (int i = 0; i < storedColorCount; i++) {
@@ -174,6 +217,7 @@ void flashAllColorsAnimation(unsigned int delayMs)
     if (storedColorCount > 0) {
         setColorFromBytes(storedColors[0]);
         colorSetIndex = 1;
+        publishColorState();
     }
 }
 
@@ -188,16 +232,46 @@ void setIndividualLEDColors(const uint8_t *colorData, size_t numLEDs)
     
     size_t maxLEDs = (numLEDs < NUM_LEDS) ? numLEDs : NUM_LEDS;
     
-    for (size_t i = 0; i < maxLEDs; i++) {
-        uint8_t r = colorData[i * 4 + 0];
-        uint8_t g = colorData[i * 4 + 1];
-        uint8_t b = colorData[i * 4 + 2];
-        uint8_t w = colorData[i * 4 + 3];
-        strip.setPixelColor(i, strip.Color(r, g, b, w));
+    uint8_t *frame = lockFrame();
+    memcpy(frame, colorData, maxLEDs * 4);
+    unlockFrame(true);
+    stopAnimation();
+}
+
+void setIndexedLEDColors(uint16_t start, const uint8_t *data, size_t length, uint8_t format, const uint8_t (*palette)[4])
+{
+    if (data == nullptr || palette == nullptr || length == 0) {
+        Serial.println("❌ Invalid indexed color data");
+        return;
     }
-    
-    strip.show();
-    animationType = 0;
+
+    uint8_t *frame = lockFrame();
+    size_t pixels = decodeIndexedPixels(frame, NUM_LEDS, start, data, length, format, palette);
+    unlockFrame(pixels > 0);
+
+    if (pixels == 0) {
+        Serial.println("❌ Indexed colors out of range");
+        return;
+    }
+    stopAnimation();
+}
+
+void setPackedLEDColors(uint16_t start, const uint8_t *data, size_t length, uint8_t format)
+{
+    if (data == nullptr || length == 0) {
+        Serial.println("❌ Invalid packed color data");
+        return;
+    }
+
+    uint8_t *frame = lockFrame();
+    size_t pixels = decodePackedPixels(frame, NUM_LEDS, start, data, length, format);
+    unlockFrame(pixels > 0);
+
+    if (pixels == 0) {
+        Serial.println("❌ Packed colors out of range or unknown format");
+        return;
+    }
+    stopAnimation();
 }
 
 void setSleepTimer(uint16_t minutes)
@@ -205,6 +279,7 @@ void setSleepTimer(uint16_t minutes)
     if (minutes == 0) {
         sleepTimerActive = false;
         sleepTimerMinutes = 0;
+        snapshotSetSleepTimer(false, 0);
         Serial.println("⏰ Sleep timer cancelled");
         return;
     }
@@ -212,6 +287,7 @@ void setSleepTimer(uint16_t minutes)
     sleepTimerStart = millis();
     sleepTimerMinutes = minutes;
     sleepTimerActive = true;
+    snapshotSetSleepTimer(true, minutes * 60UL);
     Serial.print("⏰ Sleep timer set for ");
     Serial.print(minutes);
     Serial.println(" minutes");
@@ -223,39 +299,36 @@ bool checkSleepTimer()
         return false;
     }
     
-    unsigned long elapsedMinutes = (millis() - sleepTimerStart) / 60000;
+    unsigned long elapsedSeconds = (millis() - sleepTimerStart) / 1000;
+    unsigned long totalSeconds = sleepTimerMinutes * 60UL;
     
-    if (elapsedMinutes >= sleepTimerMinutes) {
+    if (elapsedSeconds >= totalSeconds) {
         sleepTimerActive = false;
+        snapshotSetSleepTimer(false, 0);
         Serial.println("⏰ Sleep timer expired - shutting down");
         return true;
     }
     
+    snapshotSetSleepTimer(true, totalSeconds - elapsedSeconds);
     return false;
 }
 
-void setAnimation(uint8_t animType, uint8_t speed, uint8_t *params, size_t paramsLength)
+void setAnimation(uint8_t animType, uint8_t speed, const uint8_t *params, size_t paramsLength)
 {
+    size_t copyLen = (params == nullptr) ? 0 : ((paramsLength < 8) ? paramsLength : 8);
+
+    // Type, speed and colors change together so a frame never mixes old and new values
+    portENTER_CRITICAL(&animationMux);
     animationType = animType;
     animationSpeed = speed;
-    animationStep = 0;
-    animationLastUpdate = millis();
-    
-    if (params != nullptr && paramsLength > 0) {
-        size_t copyLen = (paramsLength < 8) ? paramsLength : 8;
+    if (copyLen > 0) {
         memcpy(animationParams, params, copyLen);
-        
-        if (paramsLength >= 8) {
-            animationColors[0][0] = params[0];
-            animationColors[0][1] = params[1];
-            animationColors[0][2] = params[2];
-            animationColors[0][3] = params[3];
-            animationColors[1][0] = params[4];
-            animationColors[1][1] = params[5];
-            animationColors[1][2] = params[6];
-            animationColors[1][3] = params[7];
-        }
     }
+    if (copyLen == 8) {
+        memcpy(animationColors, params, 8);
+    }
+    portEXIT_CRITICAL(&animationMux);
+    publishAnimationState();
     
     Serial.print("🎬 Animation set: type=");
     Serial.print(animType);
@@ -263,68 +336,102 @@ void setAnimation(uint8_t animType, uint8_t speed, uint8_t *params, size_t param
     Serial.println(speed);
 }
 
-void updateAnimation()
+void setTimeSync(uint32_t sharedMs, int32_t driftPpm, bool estimateDrift)
 {
-    if (animationType == 0) {
-        return;
+    portENTER_CRITICAL(&timeSyncMux);
+    if (estimateDrift) {
+        timeSyncApplyEstimate(timeSync, millis(), sharedMs);
+    } else {
+        timeSyncApply(timeSync, millis(), sharedMs, driftPpm);
     }
-    
-    unsigned long currentTime = millis();
-    if (currentTime - animationLastUpdate < animationSpeed) {
+    driftPpm = timeSync.driftPpm;
+    portEXIT_CRITICAL(&timeSyncMux);
+    snapshotSetTimeSynced(true);
+
+    Serial.print("🕒 Time sync: shared=");
+    Serial.print(sharedMs);
+    Serial.print("ms, drift=");
+    Serial.print(driftPpm);
+    Serial.println("ppm");
+}
+
+uint32_t getSyncedTime()
+{
+    portENTER_CRITICAL(&timeSyncMux);
+    uint32_t now = timeSyncNow(timeSync, millis());
+    portEXIT_CRITICAL(&timeSyncMux);
+    return now;
+}
+
+bool isAnimationActive()
+{
+    return animationType != 0;
+}
+
+void updateAnimation()
+{
+    uint8_t colors[2][4];
+    uint8_t palette[MAX_COLOR_SETS][4];
+    portENTER_CRITICAL(&animationMux);
+    uint8_t type = animationType;
+    uint8_t speed = animationSpeed;
+    uint8_t minLevel = animationParams[0];
+    memcpy(colors, animationColors, sizeof(colors));
+    memcpy(palette, storedColors, sizeof(palette));
+    int paletteCount = storedColorCount;
+    portEXIT_CRITICAL(&animationMux);
+
+    if (type == 0) {
         return;
     }
-    animationLastUpdate = currentTime;
+
+    // Phase advances 0.05 rad per `speed` ms of the shared clock, so bulbs with the same
+    // speed stay in step and the render rate can change without affecting the motion
+    double animationStep = (double)getSyncedTime() / (speed > 0 ? speed : 1);
     
-    switch (animationType) {
+    switch (type) {
         case 1: {
             float brightness = (sin(animationStep * 0.05) + 1.0) / 2.0;
-            uint8_t r = (uint8_t)(animationColors[0][0] * brightness);
-            uint8_t g = (uint8_t)(animationColors[0][1] * brightness);
-            uint8_t b = (uint8_t)(animationColors[0][2] * brightness);
-            uint8_t w = (uint8_t)(animationColors[0][3] * brightness);
+            uint8_t r = (uint8_t)(colors[0][0] * brightness);
+            uint8_t g = (uint8_t)(colors[0][1] * brightness);
+            uint8_t b = (uint8_t)(colors[0][2] * brightness);
+            uint8_t w = (uint8_t)(colors[0][3] * brightness);
             
-            for (int i = 0; i < NUM_LEDS; i++) {
-                strip.setPixelColor(i, strip.Color(r, g, b, w));
-            }
-            strip.show();
-            animationStep++;
+            fillFrame(r, g, b, w);
             break;
         }
         
         case 2: {
             float progress = (sin(animationStep * 0.05) + 1.0) / 2.0;
-            uint8_t r = (uint8_t)(animationColors[0][0] * (1.0 - progress) + animationColors[1][0] * progress);
-            uint8_t g = (uint8_t)(animationColors[0][1] * (1.0 - progress) + animationColors[1][1] * progress);
-            uint8_t b = (uint8_t)(animationColors[0][2] * (1.0 - progress) + animationColors[1][2] * progress);
-            uint8_t w = (uint8_t)(animationColors[0][3] * (1.0 - progress) + animationColors[1][3] * progress);
+            uint8_t r = (uint8_t)(colors[0][0] * (1.0 - progress) + colors[1][0] * progress);
+            uint8_t g = (uint8_t)(colors[0][1] * (1.0 - progress) + colors[1][1] * progress);
+            uint8_t b = (uint8_t)(colors[0][2] * (1.0 - progress) + colors[1][2] * progress);
+            uint8_t w = (uint8_t)(colors[0][3] * (1.0 - progress) + colors[1][3] * progress);
             
-            for (int i = 0; i < NUM_LEDS; i++) {
-                strip.setPixelColor(i, strip.Color(r, g, b, w));
-            }
-            strip.show();
-            animationStep++;
+            fillFrame(r, g, b, w);
             break;
         }
         
         case 3: {
             float brightness = (sin(animationStep * 0.05) + 1.0) / 2.0;
-            float minBrightness = animationParams[0] / 255.0;
+            float minBrightness = minLevel / 255.0;
             brightness = minBrightness + (brightness * (1.0 - minBrightness));
             
+            if (paletteCount == 0) {
+                break;
+            }
+            uint8_t *frame = lockFrame();
             for (int i = 0; i < NUM_LEDS; i++) {
-                uint8_t r = (uint8_t)(storedColors[i % storedColorCount][0] * brightness);
-                uint8_t g = (uint8_t)(storedColors[i % storedColorCount][1] * brightness);
-                uint8_t b = (uint8_t)(storedColors[i % storedColorCount][2] * brightness);
-                uint8_t w = (uint8_t)(storedColors[i % storedColorCount][3] * brightness);
-                strip.setPixelColor(i, strip.Color(r, g, b, w));
+                for (int c = 0; c < 4; c++) {
+                    frame[i * 4 + c] = (uint8_t)(palette[i % paletteCount][c] * brightness);
+                }
             }
-            strip.show();
-            animationStep++;
+            unlockFrame(true);
             break;
         }
         
         default:
-            animationType = 0;
+            stopAnimation();
             break;
     }
 }
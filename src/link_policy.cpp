@@ -0,0 +1,53 @@
+#include "link_policy.h"
+#include "config.h"
+
+static const LinkParams linkParams[] = {
+    /* LINK_IDLE */ {LINK_IDLE_INTERVAL_MIN, LINK_IDLE_INTERVAL_MAX, LINK_IDLE_LATENCY, LINK_IDLE_TIMEOUT, false},
+    /* LINK_STREAMING */ {LINK_FAST_INTERVAL_MIN, LINK_FAST_INTERVAL_MAX, 0, LINK_FAST_TIMEOUT, true},
+    /* LINK_BULK */ {LINK_FAST_INTERVAL_MIN, LINK_FAST_INTERVAL_MAX, 0, LINK_FAST_TIMEOUT, true},
+};
+
+void linkPolicyInit(LinkPolicy &policy, uint32_t now)
+{
+    // Start fast so service discovery and the first state read complete quickly
+    policy.workload = LINK_STREAMING;
+    policy.lastActivityMs = now;
+    policy.windowStartMs = now;
+    policy.windowWrites = 0;
+}
+
+void linkPolicyOnWrite(LinkPolicy &policy, bool bulk, uint32_t now)
+{
+    if (now - policy.windowStartMs >= LINK_STREAM_WINDOW_MS) {
+        policy.windowStartMs = now;
+        policy.windowWrites = 0;
+    }
+
+    if (policy.windowWrites < UINT16_MAX) {
+        policy.windowWrites++;
+    }
+
+    if (bulk) {
+        policy.workload = LINK_BULK;
+        policy.lastActivityMs = now;
+    } else if (policy.windowWrites >= LINK_STREAM_MIN_WRITES) {
+        if (policy.workload == LINK_IDLE) {
+            policy.workload = LINK_STREAMING;
+        }
+        policy.lastActivityMs = now;
+    }
+}
+
+bool linkPolicyUpdate(LinkPolicy &policy, uint32_t now)
+{
+    if (policy.workload != LINK_IDLE && now - policy.lastActivityMs >= LINK_IDLE_TIMEOUT_MS) {
+        policy.workload = LINK_IDLE;
+        return true;
+    }
+    return false;
+}
+
+const LinkParams &linkParamsFor(LinkWorkload workload)
+{
+    return linkParams[(workload <= LINK_BULK) ? workload : LINK_IDLE];
+}
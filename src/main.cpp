@@ -2,6 +2,8 @@
 #include "led_control.h"
 #include "ble_server.h"
 #include "button_handler.h"
+#include "ota_service.h"
+#include "render_task.h"
 #include <Arduino.h>
 #include <esp_sleep.h>
 
@@ -35,17 +37,20 @@ void setup()
 void loop()
 {
   handleButtonPress();
-  updateAnimation();
 
-  if (checkSleepTimer()) {
+  if (!isOTAInProgress() && checkSleepTimer()) {
     goToDeepSleep();
   }
 
   ensureBLEAdvertising();
+  updateOTA();
+  updateStateBLE();
+  updateLinkPolicy();
 
   static unsigned long lastBat = 0;
   if (millis() - lastBat > 5000) {
     updateBatteryLevelBLE();
+    publishRenderStats();
     lastBat = millis();
   }
 }
@@ -0,0 +1,286 @@
+#include "ota_service.h"
+#include "ota_session.h"
+#include "ble_server.h"
+#include "config.h"
+#include <NimBLEDevice.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+
+#define OTA_CMD_BEGIN 0x01 // [0x01][Image size: 4 bytes BE][SHA-256: 32 bytes]
+#define OTA_CMD_ABORT 0x02 // [0x02]
+
+#define OTA_RESTART_DELAY_MS 1000
+#define OTA_WRITE_OVERHEAD 5 // 3-byte ATT header + 2-byte sequence number
+
+static_assert(OTA_CHUNK_MAX + OTA_WRITE_OVERHEAD <= LINK_PREFERRED_MTU, "OTA chunk must fit one write at the preferred MTU");
+
+class EspOtaBackend : public OtaFlashBackend
+{
+public:
+    bool begin(uint32_t imageSize) override
+    {
+        partition = esp_ota_get_next_update_partition(nullptr);
+        if (partition == nullptr || imageSize > partition->size) {
+            Serial.println("❌ No OTA partition large enough for image");
+            return false;
+        }
+
+        // Sequential writes erase sector by sector instead of the whole partition up front
+        esp_err_t err = esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &handle);
+        if (err != ESP_OK) {
+            Serial.print("❌ esp_ota_begin failed: ");
+            Serial.println(err);
+            return false;
+        }
+
+        mbedtls_sha256_init(&sha);
+        mbedtls_sha256_starts(&sha, 0);
+        active = true;
+        return true;
+    }
+
+    bool write(const uint8_t *data, size_t length) override
+    {
+        mbedtls_sha256_update(&sha, data, length);
+        esp_err_t err = esp_ota_write(handle, data, length);
+        if (err != ESP_OK) {
+            Serial.print("❌ esp_ota_write failed: ");
+            Serial.println(err);
+            return false;
+        }
+        return true;
+    }
+
+    bool finish(const uint8_t *expectedHash) override
+    {
+        uint8_t hash[OTA_HASH_SIZE];
+        mbedtls_sha256_finish(&sha, hash);
+
+        // abort() releases the OTA handle and the SHA context together
+        if (memcmp(hash, expectedHash, OTA_HASH_SIZE) != 0) {
+            Serial.println("❌ OTA image hash mismatch");
+            abort();
+            return false;
+        }
+
+        mbedtls_sha256_free(&sha);
+        active = false;
+        esp_err_t err = esp_ota_end(handle);
+        if (err != ESP_OK) {
+            Serial.print("❌ esp_ota_end failed: ");
+            Serial.println(err);
+            return false;
+        }
+
+        err = esp_ota_set_boot_partition(partition);
+        if (err != ESP_OK) {
+            Serial.print("❌ esp_ota_set_boot_partition failed: ");
+            Serial.println(err);
+            return false;
+        }
+        return true;
+    }
+
+    void abort() override
+    {
+        if (active) {
+            esp_ota_abort(handle);
+            mbedtls_sha256_free(&sha);
+            active = false;
+        }
+    }
+
+private:
+    const esp_partition_t *partition = nullptr;
+    esp_ota_handle_t handle = 0;
+    mbedtls_sha256_context sha;
+    bool active = false;
+};
+
+EspOtaBackend otaBackend;
+OtaSession otaSession;
+NimBLECharacteristic *otaControlCharacteristic = nullptr;
+
+volatile bool otaBeginRequested = false;
+volatile bool otaAbortRequested = false;
+uint32_t otaRequestedSize = 0;
+uint16_t otaRequestedChunk = OTA_CHUNK_MAX;
+uint8_t otaRequestedHash[OTA_HASH_SIZE];
+unsigned long otaRestartAt = 0;
+
+static void notifyOTAStatus(OtaStatus status, uint16_t seq, uint16_t maxChunk = OTA_CHUNK_MAX)
+{
+    if (otaControlCharacteristic == nullptr) {
+        return;
+    }
+
+    uint8_t response[6] = {status, (uint8_t)(seq >> 8), (uint8_t)(seq & 0xFF), 0, 0, 0};
+    size_t length = 3;
+
+    if (status == OTA_STATUS_READY) {
+        response[3] = OTA_WINDOW_CHUNKS;
+        response[4] = maxChunk >> 8;
+        response[5] = maxChunk & 0xFF;
+        length = 6;
+    }
+
+    // Called from loop() and the NimBLE host task, so the value is passed per
+    // notification instead of going through the shared characteristic value
+    otaControlCharacteristic->notify(response, length);
+}
+
+class OtaControlCallbacks : public NimBLECharacteristicCallbacks
+{
+    void onWrite(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo) override
+    {
+        const NimBLEAttValue &value = pCharacteristic->getValue();
+        const uint8_t *data = value.data();
+        size_t length = value.size();
+
+        if (length == 0)
+            return;
+
+        switch (data[0])
+        {
+        case OTA_CMD_BEGIN:
+            if (length == 5 + OTA_HASH_SIZE) {
+                otaRequestedSize = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) |
+                                   ((uint32_t)data[3] << 8) | (uint32_t)data[4];
+                memcpy(otaRequestedHash, data + 5, OTA_HASH_SIZE);
+                // The central may have negotiated a smaller MTU than we asked for
+                otaRequestedChunk = OTA_CHUNK_MAX;
+                if (connInfo.getMTU() < OTA_CHUNK_MAX + OTA_WRITE_OVERHEAD && connInfo.getMTU() > OTA_WRITE_OVERHEAD) {
+                    otaRequestedChunk = connInfo.getMTU() - OTA_WRITE_OVERHEAD;
+                }
+                otaBeginRequested = true;
+            } else {
+                Serial.print("❌ Invalid OTA_CMD_BEGIN length: ");
+                Serial.println(length);
+            }
+            break;
+
+        case OTA_CMD_ABORT:
+            otaAbortRequested = true;
+            break;
+
+        default:
+            Serial.print("❌ Unknown OTA command: 0x");
+            Serial.println(data[0], HEX);
+            break;
+        }
+    }
+};
+
+class OtaDataCallbacks : public NimBLECharacteristicCallbacks
+{
+    void onWrite(NimBLECharacteristic *pCharacteristic, NimBLEConnInfo &connInfo) override
+    {
+        const NimBLEAttValue &value = pCharacteristic->getValue();
+        noteLinkWrite(connInfo.getConnHandle(), value.size(), true);
+        OtaStatus status = otaSessionReceive(otaSession, value.data(), value.size());
+        if (status == OTA_STATUS_NACK) {
+            notifyOTAStatus(OTA_STATUS_NACK, otaSession.nextSeq);
+        }
+    }
+};
+
+void initOTAService(NimBLEServer *server)
+{
+    otaSessionInit(otaSession, &otaBackend);
+
+    NimBLEService *otaService = server->createService(OTA_SERVICE_UUID);
+    otaControlCharacteristic = otaService->createCharacteristic(
+        OTA_CONTROL_CHARACTERISTIC_UUID,
+        NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::NOTIFY);
+    otaControlCharacteristic->setCallbacks(new OtaControlCallbacks());
+
+    NimBLECharacteristic *otaDataCharacteristic = otaService->createCharacteristic(
+        OTA_DATA_CHARACTERISTIC_UUID,
+        NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR);
+    otaDataCharacteristic->setCallbacks(new OtaDataCallbacks());
+    otaService->start();
+}
+
+bool isOTAInProgress()
+{
+    return otaSession.state == OTA_RECEIVING;
+}
+
+void updateOTA()
+{
+    if (otaAbortRequested) {
+        otaAbortRequested = false;
+        if (otaSession.state == OTA_RECEIVING) {
+            otaSessionAbort(otaSession);
+            Serial.println("🛑 OTA aborted");
+        }
+    }
+
+    if (otaBeginRequested) {
+        Serial.print("📦 OTA started, image size: ");
+        Serial.println(otaRequestedSize);
+
+        OtaStatus status = otaSessionBegin(otaSession, otaRequestedSize, otaRequestedHash, millis());
+        otaBeginRequested = false;
+        notifyOTAStatus(status, 0, otaRequestedChunk);
+        if (status == OTA_STATUS_ERROR) {
+            Serial.println("❌ Failed to start OTA");
+        }
+    }
+
+    OtaStatus status = otaSessionService(otaSession, millis());
+    switch (status)
+    {
+    case OTA_STATUS_ACK:
+        notifyOTAStatus(OTA_STATUS_ACK, otaSession.ackedSeq);
+        break;
+
+    case OTA_STATUS_DONE: {
+        uint32_t bytesPerSecond = otaSessionThroughput(otaSession);
+        notifyOTAStatus(OTA_STATUS_DONE, otaSession.nextSeq);
+        Serial.print("✅ OTA complete, ");
+        Serial.print(bytesPerSecond / 1024.0, 1);
+        Serial.println(" KB/s - restarting...");
+        otaRestartAt = millis() + OTA_RESTART_DELAY_MS;
+        break;
+    }
+
+    case OTA_STATUS_ERROR:
+        notifyOTAStatus(OTA_STATUS_ERROR, otaSession.nextSeq);
+        Serial.println("❌ OTA failed");
+        break;
+
+    default:
+        break;
+    }
+
+    if (otaRestartAt != 0 && (long)(millis() - otaRestartAt) >= 0) {
+        ESP.restart();
+    }
+}
+
+// Keep a freshly flashed image pending until BLE is up; the bootloader rolls back otherwise
+extern "C" bool verifyRollbackLater()
+{
+    return true;
+}
+
+void confirmOTABoot()
+{
+    esp_ota_img_states_t state;
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (esp_ota_get_state_partition(running, &state) == ESP_OK && state == ESP_OTA_IMG_PENDING_VERIFY) {
+        esp_ota_mark_app_valid_cancel_rollback();
+        Serial.println("✅ New firmware confirmed");
+    }
+}
+
+void rejectOTABoot()
+{
+    esp_ota_img_states_t state;
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    if (esp_ota_get_state_partition(running, &state) == ESP_OK && state == ESP_OTA_IMG_PENDING_VERIFY) {
+        Serial.println("⚠️ New firmware failed to start BLE - rolling back");
+        esp_ota_mark_app_invalid_rollback_and_reboot();
+    }
+}
@@ -0,0 +1,183 @@
+#include "ota_session.h"
+#include <string.h>
+
+static void resetTransfer(OtaSession &session)
+{
+    session.nextSeq.store(0, std::memory_order_relaxed);
+    session.receiveComplete.store(false, std::memory_order_relaxed);
+    session.received = 0;
+    session.fillIndex = 0;
+    session.nackSent = false;
+    session.ackedSeq = 0;
+    session.written = 0;
+    session.flushIndex = 0;
+    session.bufferLength[0] = 0;
+    session.bufferLength[1] = 0;
+    session.bufferReady[0].store(false, std::memory_order_relaxed);
+    session.bufferReady[1].store(false, std::memory_order_relaxed);
+}
+
+void otaSessionInit(OtaSession &session, OtaFlashBackend *backend)
+{
+    session.backend = backend;
+    session.state.store(OTA_IDLE, std::memory_order_relaxed);
+    session.imageSize = 0;
+    session.startMs = 0;
+    session.endMs = 0;
+    resetTransfer(session);
+}
+
+OtaStatus otaSessionBegin(OtaSession &session, uint32_t imageSize, const uint8_t *expectedHash, uint32_t now)
+{
+    if (session.state == OTA_RECEIVING) {
+        otaSessionAbort(session);
+    }
+
+    resetTransfer(session);
+    session.imageSize = imageSize;
+    memcpy(session.expectedHash, expectedHash, OTA_HASH_SIZE);
+
+    if (imageSize == 0 || session.backend == nullptr || !session.backend->begin(imageSize)) {
+        session.state.store(OTA_FAILED, std::memory_order_release);
+        return OTA_STATUS_ERROR;
+    }
+
+    session.startMs = now;
+    session.endMs = now;
+    // Publishes the reset transfer state to the receiving side
+    session.state.store(OTA_RECEIVING, std::memory_order_release);
+    return OTA_STATUS_READY;
+}
+
+static void markFillReady(OtaSession &session)
+{
+    session.bufferReady[session.fillIndex].store(true, std::memory_order_release);
+    session.fillIndex ^= 1;
+}
+
+OtaStatus otaSessionReceive(OtaSession &session, const uint8_t *data, size_t length)
+{
+    if (session.state.load(std::memory_order_acquire) != OTA_RECEIVING ||
+        session.receiveComplete.load(std::memory_order_relaxed)) {
+        return OTA_STATUS_ERROR;
+    }
+
+    if (data == nullptr || length < 3 || length - 2 > OTA_CHUNK_MAX) {
+        return OTA_STATUS_ERROR;
+    }
+
+    uint16_t seq = (data[0] << 8) | data[1];
+    const uint8_t *payload = data + 2;
+    size_t payloadLength = length - 2;
+
+    // Acquire before touching a buffer the flashing side may just have released
+    uint8_t fill = session.fillIndex;
+    bool fillBusy = session.bufferReady[fill].load(std::memory_order_acquire);
+    bool otherBusy = session.bufferReady[fill ^ 1].load(std::memory_order_acquire);
+    size_t space = fillBusy ? 0 : OTA_BUFFER_SIZE - session.bufferLength[fill];
+
+    // A sender respecting the window never hits a buffer that is still being flashed
+    bool accept = seq == session.nextSeq.load(std::memory_order_relaxed) &&
+                  payloadLength <= session.imageSize - session.received &&
+                  !fillBusy &&
+                  !(payloadLength > space && otherBusy);
+
+    if (!accept) {
+        // One NACK per gap; the sender rewinds to nextSeq and the rest of its window is dropped
+        if (session.nackSent) {
+            return OTA_STATUS_NONE;
+        }
+        session.nackSent = true;
+        return OTA_STATUS_NACK;
+    }
+
+    size_t first = (payloadLength < space) ? payloadLength : space;
+    memcpy(session.buffers[fill] + session.bufferLength[fill], payload, first);
+    session.bufferLength[fill] += first;
+
+    if (session.bufferLength[fill] == OTA_BUFFER_SIZE) {
+        markFillReady(session);
+    }
+
+    if (first < payloadLength) {
+        fill = session.fillIndex;
+        memcpy(session.buffers[fill], payload + first, payloadLength - first);
+        session.bufferLength[fill] = payloadLength - first;
+    }
+
+    session.received += payloadLength;
+    session.nackSent = false;
+    session.nextSeq.store(seq + 1, std::memory_order_release);
+
+    if (session.received == session.imageSize) {
+        if (session.bufferLength[session.fillIndex] > 0) {
+            markFillReady(session);
+        }
+        session.receiveComplete.store(true, std::memory_order_release);
+    }
+
+    return OTA_STATUS_NONE;
+}
+
+OtaStatus otaSessionService(OtaSession &session, uint32_t now)
+{
+    if (session.state.load(std::memory_order_relaxed) != OTA_RECEIVING) {
+        return OTA_STATUS_NONE;
+    }
+
+    uint8_t flush = session.flushIndex;
+    if (session.bufferReady[flush].load(std::memory_order_acquire)) {
+        if (!session.backend->write(session.buffers[flush], session.bufferLength[flush])) {
+            otaSessionAbort(session);
+            return OTA_STATUS_ERROR;
+        }
+        session.written += session.bufferLength[flush];
+        session.bufferLength[flush] = 0;
+        session.bufferReady[flush].store(false, std::memory_order_release);
+        session.flushIndex ^= 1;
+    }
+
+    bool complete = session.receiveComplete.load(std::memory_order_acquire);
+    bool buffersFree = !session.bufferReady[0].load(std::memory_order_acquire) &&
+                       !session.bufferReady[1].load(std::memory_order_acquire);
+
+    if (complete && buffersFree) {
+        session.endMs = now;
+        if (session.written != session.imageSize) {
+            otaSessionAbort(session);
+            return OTA_STATUS_ERROR;
+        }
+        if (!session.backend->finish(session.expectedHash)) {
+            session.state.store(OTA_FAILED, std::memory_order_release);
+            return OTA_STATUS_ERROR;
+        }
+        session.state.store(OTA_DONE, std::memory_order_release);
+        return OTA_STATUS_DONE;
+    }
+
+    // Only grant a new window when a whole buffer is free to absorb it
+    uint16_t nextSeq = session.nextSeq.load(std::memory_order_acquire);
+    if (buffersFree && (uint16_t)(nextSeq - session.ackedSeq) >= OTA_ACK_EVERY) {
+        session.ackedSeq = nextSeq;
+        return OTA_STATUS_ACK;
+    }
+
+    return OTA_STATUS_NONE;
+}
+
+void otaSessionAbort(OtaSession &session)
+{
+    if (session.state.load(std::memory_order_relaxed) == OTA_RECEIVING && session.backend != nullptr) {
+        session.backend->abort();
+    }
+    session.state.store(OTA_FAILED, std::memory_order_release);
+}
+
+uint32_t otaSessionThroughput(const OtaSession &session)
+{
+    uint32_t elapsed = session.endMs - session.startMs;
+    if (elapsed == 0) {
+        return 0;
+    }
+    return (uint32_t)((uint64_t)session.written * 1000 / elapsed);
+}
@@ -0,0 +1,108 @@
+#include "pixel_formats.h"
+#include <string.h>
+
+static size_t clampPixels(size_t framePixels, size_t start, size_t pixels)
+{
+    if (start >= framePixels) {
+        return 0;
+    }
+    return (pixels < framePixels - start) ? pixels : framePixels - start;
+}
+
+size_t indexedPixelCount(uint8_t format, size_t length)
+{
+    switch (format) {
+        case 8:
+            return length;
+        case 4:
+            return length * 2;
+        case 4 | INDEXED_ODD_COUNT:
+            return (length > 0) ? length * 2 - 1 : 0;
+        default:
+            return 0;
+    }
+}
+
+size_t decodeIndexedPixels(uint8_t *frame, size_t framePixels, size_t start,
+                           const uint8_t *data, size_t length, uint8_t format,
+                           const uint8_t (*palette)[4])
+{
+    size_t pixels = clampPixels(framePixels, start, indexedPixelCount(format, length));
+    uint8_t *out = frame + start * 4;
+
+    if (format == 8) {
+        for (size_t i = 0; i < pixels; i++) {
+            memcpy(out + i * 4, palette[data[i]], 4);
+        }
+    } else {
+        for (size_t i = 0; i < pixels; i++) {
+            uint8_t packed = data[i >> 1];
+            uint8_t index = (i & 1) ? (packed & 0x0F) : (packed >> 4);
+            memcpy(out + i * 4, palette[index], 4);
+        }
+    }
+
+    return pixels;
+}
+
+size_t packedPixelSize(uint8_t format)
+{
+    switch (format) {
+        case PIXEL_FORMAT_RGB565:
+        case PIXEL_FORMAT_RGBW4444:
+            return 2;
+        case PIXEL_FORMAT_RGB332:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+size_t decodePackedPixels(uint8_t *frame, size_t framePixels, size_t start,
+                          const uint8_t *data, size_t length, uint8_t format)
+{
+    size_t pixelSize = packedPixelSize(format);
+    if (pixelSize == 0) {
+        return 0;
+    }
+
+    size_t pixels = clampPixels(framePixels, start, length / pixelSize);
+    uint8_t *out = frame + start * 4;
+
+    for (size_t i = 0; i < pixels; i++, out += 4) {
+        switch (format) {
+            case PIXEL_FORMAT_RGB565: {
+                uint16_t v = (data[i * 2] << 8) | data[i * 2 + 1];
+                uint8_t r = v >> 11;
+                uint8_t g = (v >> 5) & 0x3F;
+                uint8_t b = v & 0x1F;
+                out[0] = (r << 3) | (r >> 2);
+                out[1] = (g << 2) | (g >> 4);
+                out[2] = (b << 3) | (b >> 2);
+                out[3] = 0;
+                break;
+            }
+
+            case PIXEL_FORMAT_RGB332: {
+                uint8_t v = data[i];
+                uint8_t r = v >> 5;
+                uint8_t g = (v >> 2) & 0x07;
+                uint8_t b = v & 0x03;
+                out[0] = (r << 5) | (r << 2) | (r >> 1);
+                out[1] = (g << 5) | (g << 2) | (g >> 1);
+                out[2] = b * 0x55;
+                out[3] = 0;
+                break;
+            }
+
+            case PIXEL_FORMAT_RGBW4444:
+                out[0] = (data[i * 2] >> 4) * 0x11;
+                out[1] = (data[i * 2] & 0x0F) * 0x11;
+                out[2] = (data[i * 2 + 1] >> 4) * 0x11;
+                out[3] = (data[i * 2 + 1] & 0x0F) * 0x11;
+                break;
+        }
+    }
+
+    return pixels;
+}
@@ -0,0 +1,71 @@
+#include "power_budget.h"
+#include "config.h"
+
+void sumFrameChannels(const uint8_t *frame, size_t pixels, FrameChannelSums &sums)
+{
+    sums.r = 0;
+    sums.g = 0;
+    sums.b = 0;
+    sums.w = 0;
+
+    for (size_t i = 0; i < pixels; i++) {
+        sums.r += frame[i * 4 + 0];
+        sums.g += frame[i * 4 + 1];
+        sums.b += frame[i * 4 + 2];
+        sums.w += frame[i * 4 + 3];
+    }
+}
+
+static uint32_t channelCurrentUa(const FrameChannelSums &sums)
+{
+    return sums.r / 255 * LED_CURRENT_R_UA + (sums.r % 255) * LED_CURRENT_R_UA / 255 +
+           sums.g / 255 * LED_CURRENT_G_UA + (sums.g % 255) * LED_CURRENT_G_UA / 255 +
+           sums.b / 255 * LED_CURRENT_B_UA + (sums.b % 255) * LED_CURRENT_B_UA / 255 +
+           sums.w / 255 * LED_CURRENT_W_UA + (sums.w % 255) * LED_CURRENT_W_UA / 255;
+}
+
+uint32_t estimateFrameCurrent(const uint8_t *frame, size_t pixels)
+{
+    FrameChannelSums sums;
+    sumFrameChannels(frame, pixels, sums);
+    return (channelCurrentUa(sums) + pixels * LED_CURRENT_IDLE_UA) / 1000;
+}
+
+uint32_t powerBudgetForBattery(int percent)
+{
+    if (percent >= POWER_BUDGET_FULL_PERCENT) {
+        return POWER_BUDGET_MA;
+    }
+    if (percent <= 0) {
+        return POWER_BUDGET_MIN_MA;
+    }
+    return POWER_BUDGET_MIN_MA + (uint32_t)(POWER_BUDGET_MA - POWER_BUDGET_MIN_MA) * percent / POWER_BUDGET_FULL_PERCENT;
+}
+
+uint16_t limitFramePower(uint8_t *frame, size_t pixels, uint32_t budgetMa, uint32_t *estimateMa)
+{
+    FrameChannelSums sums;
+    sumFrameChannels(frame, pixels, sums);
+
+    uint32_t idleUa = pixels * LED_CURRENT_IDLE_UA;
+    uint32_t channelUa = channelCurrentUa(sums);
+    uint32_t budgetUa = budgetMa * 1000;
+
+    if (estimateMa != nullptr) {
+        *estimateMa = (channelUa + idleUa) / 1000;
+    }
+
+    if (channelUa + idleUa <= budgetUa) {
+        return 256;
+    }
+
+    // Scale is 8.8 fixed point; idle current cannot be scaled away
+    uint32_t availableUa = (budgetUa > idleUa) ? budgetUa - idleUa : 0;
+    uint16_t scale = (uint16_t)((uint64_t)availableUa * 256 / channelUa);
+
+    for (size_t i = 0; i < pixels * 4; i++) {
+        frame[i] = (uint8_t)((frame[i] * scale) >> 8);
+    }
+
+    return scale;
+}
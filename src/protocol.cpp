@@ -0,0 +1,120 @@
+#include "protocol.h"
+#include "config.h"
+#include "pixel_formats.h"
+
+static constexpr CommandDescriptor commandTable[COMMAND_COUNT] = {
+    /* 0x00 */ {nullptr, 0, 0, 0, 0},
+    /* 0x01 */ {"CMD_SET_COLOR", 5, 5, 0, 0},
+    /* 0x02 */ {"CMD_SET_COLOR_SETS", 5, 1 + MAX_COLOR_SETS * 4, 1, 4},
+    /* 0x03 */ {"CMD_DISABLE_BLE", 1, 0, 0, 0},
+    /* 0x04 */ {"CMD_SET_INDIVIDUAL_COLORS", 5, 0, 1, 4},
+    /* 0x05 */ {"CMD_SET_SLEEP_TIMER", 3, 3, 0, 0},
+    /* 0x06 */ {"CMD_SET_ANIMATION", 3, 0, 0, 0},
+    /* 0x07 */ {"CMD_SET_TIME_SYNC", 5, 7, 5, 2},
+    /* 0x08 */ {"CMD_SET_PALETTE", 6, 2 + PALETTE_MAX_COLORS * 4, 2, 4},
+    /* 0x09 */ {"CMD_SET_INDEXED_COLORS", 5, 0, 0, 0},
+    /* 0x0A */ {"CMD_SET_PACKED_COLORS", 5, 0, 0, 0},
+};
+
+static_assert(COMMAND_COUNT == CMD_SET_PACKED_COLORS + 1, "Command table out of sync with config.h");
+
+static inline uint16_t readU16(const uint8_t *data)
+{
+    return (uint16_t)((data[0] << 8) | data[1]);
+}
+
+static inline uint32_t readU32(const uint8_t *data)
+{
+    return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+const CommandDescriptor *commandDescriptor(uint8_t id)
+{
+    if (id >= COMMAND_COUNT || commandTable[id].name == nullptr) {
+        return nullptr;
+    }
+    return &commandTable[id];
+}
+
+ParseResult parseCommand(const uint8_t *data, size_t length, Command &command)
+{
+    if (data == nullptr || length == 0) {
+        return PARSE_EMPTY;
+    }
+
+    command.id = data[0];
+    command.length = (length > UINT16_MAX) ? UINT16_MAX : (uint16_t)length;
+
+    const CommandDescriptor *descriptor = commandDescriptor(command.id);
+    if (descriptor == nullptr) {
+        return PARSE_UNKNOWN_COMMAND;
+    }
+
+    if (length < descriptor->minLength ||
+        (descriptor->maxLength != 0 && length > descriptor->maxLength) ||
+        (descriptor->stride != 0 && (length - descriptor->strideOffset) % descriptor->stride != 0)) {
+        return PARSE_INVALID_LENGTH;
+    }
+
+    const uint8_t *payload = data + 1;
+    size_t payloadLength = length - 1;
+
+    switch (command.id) {
+        case CMD_SET_COLOR:
+            command.color.color = payload;
+            break;
+
+        case CMD_SET_COLOR_SETS:
+        case CMD_SET_INDIVIDUAL_COLORS:
+            command.colorList.colors = payload;
+            command.colorList.count = payloadLength / 4;
+            break;
+
+        case CMD_DISABLE_BLE:
+            break;
+
+        case CMD_SET_SLEEP_TIMER:
+            command.sleepTimer.minutes = readU16(payload);
+            break;
+
+        case CMD_SET_ANIMATION:
+            command.animation.type = payload[0];
+            command.animation.speed = payload[1];
+            command.animation.params = (payloadLength > 2) ? payload + 2 : nullptr;
+            command.animation.paramsLength = payloadLength - 2;
+            break;
+
+        case CMD_SET_TIME_SYNC:
+            command.timeSync.sharedMs = readU32(payload);
+            command.timeSync.hasDrift = (payloadLength == 6);
+            command.timeSync.driftPpm = command.timeSync.hasDrift ? (int16_t)readU16(payload + 4) : 0;
+            break;
+
+        case CMD_SET_PALETTE:
+            command.palette.startIndex = payload[0];
+            command.palette.colors = payload + 1;
+            command.palette.count = (payloadLength - 1) / 4;
+            if (command.palette.startIndex + command.palette.count > PALETTE_MAX_COLORS) {
+                return PARSE_INVALID_VALUE;
+            }
+            break;
+
+        case CMD_SET_INDEXED_COLORS:
+        case CMD_SET_PACKED_COLORS:
+            command.pixels.format = payload[0];
+            command.pixels.start = readU16(payload + 1);
+            command.pixels.data = payload + 3;
+            command.pixels.length = payloadLength - 3;
+            if (command.id == CMD_SET_INDEXED_COLORS) {
+                if (indexedPixelCount(command.pixels.format, command.pixels.length) == 0) {
+                    return PARSE_INVALID_VALUE;
+                }
+            } else if (packedPixelSize(command.pixels.format) == 0 ||
+                       command.pixels.length % packedPixelSize(command.pixels.format) != 0) {
+                return PARSE_INVALID_VALUE;
+            }
+            break;
+    }
+
+    return PARSE_OK;
+}
@@ -0,0 +1,250 @@
+#include "render_task.h"
+#include "led_control.h"
+#include "config.h"
+#include "power_budget.h"
+#include "frame_governor.h"
+#include "state_snapshot.h"
+#include <Adafruit_NeoPixel.h>
+
+Adafruit_NeoPixel strip(NUM_LEDS, LED_PIN, NEO_GRBW + NEO_KHZ800);
+
+// Back buffer is written by commands and animations, front buffer is owned by the wire
+uint8_t backFrame[NUM_LEDS * 4] = {0};
+uint8_t frontFrame[NUM_LEDS * 4] = {0};
+uint8_t lastFrame[NUM_LEDS * 4] = {0}; // Last shown frame before power limiting
+bool backFrameDirty = false;
+bool backFrameRelimit = false; // Set when the power budget changed, so the frame is re-shown as is
+SemaphoreHandle_t frameMutex = nullptr;
+
+TaskHandle_t renderTaskHandle = nullptr;
+volatile bool renderRunning = false;
+volatile bool renderStopRequested = false;
+
+portMUX_TYPE renderStatsMux = portMUX_INITIALIZER_UNLOCKED;
+RenderStats renderStats = {0, 0, 0, 0, 0, 0, 0, POWER_BUDGET_MA, 0, FRAME_INTERVAL_MIN_MS, 0};
+uint64_t renderTotalUs = 0;
+
+FrameGovernor frameGovernor;
+
+// Full budget and frame rate until the first battery reading arrives
+volatile int renderBatteryPercent = 100;
+volatile uint32_t powerBudgetMa = POWER_BUDGET_MA;
+
+static void showFrontFrame()
+{
+    for (int i = 0; i < NUM_LEDS; i++) {
+        const uint8_t *pixel = &frontFrame[i * 4];
+        strip.setPixelColor(i, strip.Color(pixel[0], pixel[1], pixel[2], pixel[3]));
+    }
+    strip.show();
+}
+
+// Copies the back buffer at a frame boundary; returns false if nothing changed
+static bool swapFrames(bool &relimit)
+{
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    bool dirty = backFrameDirty;
+    relimit = backFrameRelimit;
+    if (dirty) {
+        memcpy(frontFrame, backFrame, sizeof(frontFrame));
+        backFrameDirty = false;
+        backFrameRelimit = false;
+    }
+    xSemaphoreGive(frameMutex);
+    return dirty;
+}
+
+static void recordFrame(uint32_t frameUs, uint32_t currentMa, bool limited)
+{
+    portENTER_CRITICAL(&renderStatsMux);
+    renderStats.frames++;
+    renderStats.lastCurrentMa = currentMa;
+    renderStats.budgetMa = powerBudgetMa;
+    if (limited) {
+        renderStats.limitedFrames++;
+    }
+    renderStats.lastFrameUs = frameUs;
+    if (frameUs > renderStats.maxFrameUs) {
+        renderStats.maxFrameUs = frameUs;
+    }
+    if (frameUs > RENDER_FRAME_INTERVAL_MS * 1000UL) {
+        renderStats.missedDeadlines++;
+    }
+    renderTotalUs += frameUs;
+    renderStats.avgFrameUs = (uint32_t)(renderTotalUs / renderStats.frames);
+    portEXIT_CRITICAL(&renderStatsMux);
+}
+
+static void recordGovernor()
+{
+    portENTER_CRITICAL(&renderStatsMux);
+    renderStats.droppedFrames = frameGovernor.dropped;
+    renderStats.frameIntervalMs = frameGovernor.intervalMs;
+    renderStats.effectiveFpsX10 = frameGovernor.effectiveFpsX10;
+    portEXIT_CRITICAL(&renderStatsMux);
+}
+
+static void renderTask(void *parameter)
+{
+    TickType_t lastWake = xTaskGetTickCount();
+    frameGovernorInit(frameGovernor, millis());
+
+    while (!renderStopRequested) {
+        unsigned long frameStart = micros();
+
+        // Animations render at the governor's rate; command writes go out at the next boundary
+        bool animating = isAnimationActive();
+        bool animationFrame = animating && frameGovernorDue(frameGovernor, millis());
+        if (animationFrame) {
+            updateAnimation();
+        } else if (!animating) {
+            bool wasReporting = frameGovernor.effectiveFpsX10 != 0;
+            frameGovernorIdle(frameGovernor, millis());
+            if (wasReporting) {
+                recordGovernor();
+            }
+        }
+
+        bool relimit;
+        if (swapFrames(relimit)) {
+            // Only an animation frame with no visible change is skipped (and counted as dropped)
+            uint8_t delta = frameDelta(frontFrame, lastFrame, sizeof(frontFrame));
+            bool show = delta > 0 || !animationFrame || relimit;
+
+            if (show) {
+                memcpy(lastFrame, frontFrame, sizeof(lastFrame));
+                snapshotSetFrame(lastFrame, !animationFrame);
+                uint32_t currentMa = 0;
+                bool limited = limitFramePower(frontFrame, NUM_LEDS, powerBudgetMa, &currentMa) < 256;
+                showFrontFrame();
+                recordFrame(micros() - frameStart, currentMa, limited);
+            }
+
+            if (animationFrame) {
+                frameGovernorUpdate(frameGovernor, delta, show, renderBatteryPercent, millis());
+                recordGovernor();
+            }
+        }
+
+        vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(RENDER_FRAME_INTERVAL_MS));
+    }
+
+    renderRunning = false;
+    renderTaskHandle = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void initRenderTask()
+{
+    strip.setPin(LED_PIN);
+    strip.begin();
+    strip.show();
+
+    if (frameMutex == nullptr) {
+        frameMutex = xSemaphoreCreateMutex();
+    }
+
+    renderStopRequested = false;
+    renderRunning = true;
+    if (xTaskCreate(renderTask, "render", RENDER_TASK_STACK_SIZE, nullptr, RENDER_TASK_PRIORITY, &renderTaskHandle) != pdPASS) {
+        renderRunning = false;
+        Serial.println("❌ Failed to start render task, showing frames synchronously");
+    }
+}
+
+void stopRenderTask()
+{
+    if (!renderRunning) {
+        return;
+    }
+
+    renderStopRequested = true;
+    while (renderRunning) {
+        delay(1);
+    }
+}
+
+uint8_t *lockFrame()
+{
+    xSemaphoreTake(frameMutex, portMAX_DELAY);
+    return backFrame;
+}
+
+void unlockFrame(bool changed)
+{
+    if (changed) {
+        backFrameDirty = true;
+    }
+    xSemaphoreGive(frameMutex);
+
+    // Without the task (not started or stopped for deep sleep) the caller drives the wire
+    bool relimit;
+    if (changed && !renderRunning && swapFrames(relimit)) {
+        limitFramePower(frontFrame, NUM_LEDS, powerBudgetMa, nullptr);
+        showFrontFrame();
+    }
+}
+
+void setRenderBatteryPercent(int percent)
+{
+    renderBatteryPercent = percent;
+    uint32_t budgetMa = powerBudgetForBattery(percent);
+    if (budgetMa == powerBudgetMa) {
+        return;
+    }
+    powerBudgetMa = budgetMa;
+
+    // A static frame is only limited when it changes, so re-limit it against the new budget
+    if (frameMutex != nullptr) {
+        xSemaphoreTake(frameMutex, portMAX_DELAY);
+        backFrameDirty = true;
+        backFrameRelimit = true;
+        xSemaphoreGive(frameMutex);
+    }
+}
+
+void getRenderStats(RenderStats &stats)
+{
+    portENTER_CRITICAL(&renderStatsMux);
+    stats = renderStats;
+    portEXIT_CRITICAL(&renderStatsMux);
+}
+
+void publishRenderStats()
+{
+    RenderStats stats;
+    getRenderStats(stats);
+    snapshotSetRender(stats);
+}
+
+void debugRender()
+{
+    RenderStats stats;
+    getRenderStats(stats);
+
+    Serial.print("🖼️ Frames: ");
+    Serial.print(stats.frames);
+    Serial.print(", missed deadlines: ");
+    Serial.print(stats.missedDeadlines);
+    Serial.print(", frame time last/avg/max: ");
+    Serial.print(stats.lastFrameUs);
+    Serial.print("/");
+    Serial.print(stats.avgFrameUs);
+    Serial.print("/");
+    Serial.print(stats.maxFrameUs);
+    Serial.println(" us");
+
+    Serial.print("⚡ Estimated current: ");
+    Serial.print(stats.lastCurrentMa);
+    Serial.print(" mA, budget: ");
+    Serial.print(stats.budgetMa);
+    Serial.print(" mA, limited frames: ");
+    Serial.println(stats.limitedFrames);
+
+    Serial.print("🎞️ Animation: ");
+    Serial.print(stats.effectiveFpsX10 / 10.0, 1);
+    Serial.print(" fps, interval: ");
+    Serial.print(stats.frameIntervalMs);
+    Serial.print(" ms, dropped frames: ");
+    Serial.println(stats.droppedFrames);
+}
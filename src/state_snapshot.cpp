@@ -0,0 +1,160 @@
+#include "state_snapshot.h"
+
+// Written in place by whichever task changes the state, copied out when dirty
+portMUX_TYPE snapshotMux = portMUX_INITIALIZER_UNLOCKED;
+uint8_t snapshot[SNAPSHOT_SIZE] = {0};
+bool snapshotDirty = false;
+
+static void writeField(uint16_t offset, const uint8_t *data, size_t length, bool notify = true)
+{
+    portENTER_CRITICAL(&snapshotMux);
+    if (memcmp(&snapshot[offset], data, length) != 0) {
+        memcpy(&snapshot[offset], data, length);
+        snapshotDirty = snapshotDirty || notify;
+    }
+    portEXIT_CRITICAL(&snapshotMux);
+}
+
+static void setFlag(uint8_t flag, bool enabled)
+{
+    portENTER_CRITICAL(&snapshotMux);
+    uint8_t flags = snapshot[SNAPSHOT_OFFSET_FLAGS];
+    flags = enabled ? (flags | flag) : (flags & ~flag);
+    if (flags != snapshot[SNAPSHOT_OFFSET_FLAGS]) {
+        snapshot[SNAPSHOT_OFFSET_FLAGS] = flags;
+        snapshotDirty = true;
+    }
+    portEXIT_CRITICAL(&snapshotMux);
+}
+
+void initStateSnapshot()
+{
+    uint8_t header[3] = {SNAPSHOT_VERSION, (uint8_t)(NUM_LEDS >> 8), (uint8_t)(NUM_LEDS & 0xFF)};
+    writeField(SNAPSHOT_OFFSET_VERSION, header, sizeof(header));
+
+    uint8_t firmware[8] = {0};
+    strncpy((char *)firmware, FIRMWARE_VERSION, sizeof(firmware));
+    writeField(SNAPSHOT_OFFSET_FIRMWARE, firmware, sizeof(firmware));
+    setFlag(SNAPSHOT_FLAG_FRAME_TRUNCATED, SNAPSHOT_FRAME_LEDS < NUM_LEDS);
+}
+
+void snapshotSetColors(const uint8_t (*colors)[4], int count, int index)
+{
+    uint8_t data[2 + MAX_COLOR_SETS * 4] = {0};
+    data[0] = (uint8_t)count;
+    data[1] = (uint8_t)index;
+    if (count > 0 && count <= MAX_COLOR_SETS) {
+        memcpy(&data[2], colors, count * 4);
+    }
+    writeField(SNAPSHOT_OFFSET_COLOR_COUNT, data, sizeof(data));
+}
+
+void snapshotSetAnimation(uint8_t type, uint8_t speed, const uint8_t *params)
+{
+    uint8_t data[10] = {type, speed};
+    memcpy(&data[2], params, 8);
+    writeField(SNAPSHOT_OFFSET_ANIMATION_TYPE, data, sizeof(data));
+    setFlag(SNAPSHOT_FLAG_ANIMATION, type != 0);
+}
+
+void snapshotSetSleepTimer(bool active, uint32_t remainingSeconds)
+{
+    uint8_t data[4] = {
+        (uint8_t)(remainingSeconds >> 24), (uint8_t)(remainingSeconds >> 16),
+        (uint8_t)(remainingSeconds >> 8), (uint8_t)(remainingSeconds & 0xFF)};
+    writeField(SNAPSHOT_OFFSET_TIMER_REMAINING, data, sizeof(data));
+    setFlag(SNAPSHOT_FLAG_SLEEP_TIMER, active);
+}
+
+void snapshotSetTimeSynced(bool synced)
+{
+    setFlag(SNAPSHOT_FLAG_TIME_SYNCED, synced);
+}
+
+void snapshotSetBattery(uint8_t percent)
+{
+    writeField(SNAPSHOT_OFFSET_BATTERY, &percent, 1);
+}
+
+static void putU16(uint8_t *out, uint32_t value)
+{
+    if (value > 0xFFFF) value = 0xFFFF;
+    out[0] = value >> 8;
+    out[1] = value & 0xFF;
+}
+
+static void putU32(uint8_t *out, uint32_t value)
+{
+    out[0] = value >> 24;
+    out[1] = value >> 16;
+    out[2] = value >> 8;
+    out[3] = value & 0xFF;
+}
+
+void snapshotSetRender(const RenderStats &stats)
+{
+    uint8_t data[SNAPSHOT_RENDER_SIZE];
+    putU16(&data[0], stats.avgFrameUs);
+    putU16(&data[2], stats.maxFrameUs);
+    putU32(&data[4], stats.missedDeadlines);
+    putU32(&data[8], stats.droppedFrames);
+    putU32(&data[12], stats.limitedFrames);
+    putU16(&data[16], stats.effectiveFpsX10);
+    putU16(&data[18], stats.frameIntervalMs);
+    putU16(&data[20], stats.lastCurrentMa);
+    putU16(&data[22], stats.budgetMa);
+    writeField(SNAPSHOT_OFFSET_RENDER, data, sizeof(data));
+}
+
+// Animated frames are only picked up by reads, notifying them would stream the animation
+void snapshotSetFrame(const uint8_t *frame, bool notify)
+{
+    writeField(SNAPSHOT_OFFSET_FRAME, frame, SNAPSHOT_FRAME_LEDS * 4, notify);
+}
+
+void snapshotSetLink(int slot, const LinkInfo &info)
+{
+    if (slot < 0 || slot >= BLE_MAX_CONNECTIONS) {
+        return;
+    }
+    uint8_t data[SNAPSHOT_LINK_SIZE] = {
+        (uint8_t)(info.connHandle >> 8), (uint8_t)(info.connHandle & 0xFF),
+        (uint8_t)(info.interval >> 8), (uint8_t)(info.interval & 0xFF),
+        (uint8_t)(info.latency >> 8), (uint8_t)(info.latency & 0xFF),
+        (uint8_t)(info.timeout >> 8), (uint8_t)(info.timeout & 0xFF),
+        info.txPhy, info.rxPhy,
+        (uint8_t)(info.mtu >> 8), (uint8_t)(info.mtu & 0xFF),
+        info.workload};
+    writeField(SNAPSHOT_OFFSET_LINKS + slot * SNAPSHOT_LINK_SIZE, data, sizeof(data));
+}
+
+void snapshotSetAdvertising(const AdvStats &stats, uint32_t averageTimeToConnectMs)
+{
+    uint8_t data[SNAPSHOT_ADV_SIZE];
+    putU16(&data[0], stats.fastConnects);
+    putU16(&data[2], stats.slowConnects);
+    putU16(&data[4], stats.lastTimeToConnectMs);
+    putU16(&data[6], stats.connects > 0 ? stats.minTimeToConnectMs : 0);
+    putU16(&data[8], averageTimeToConnectMs);
+    putU16(&data[10], stats.maxTimeToConnectMs);
+    writeField(SNAPSHOT_OFFSET_ADV, data, sizeof(data));
+}
+
+bool takeStateSnapshot(uint8_t *out)
+{
+    portENTER_CRITICAL(&snapshotMux);
+    bool dirty = snapshotDirty;
+    if (dirty) {
+        memcpy(out, snapshot, SNAPSHOT_SIZE);
+        snapshotDirty = false;
+    }
+    portEXIT_CRITICAL(&snapshotMux);
+    return dirty;
+}
+
+void readStateSnapshot(uint8_t *out)
+{
+    portENTER_CRITICAL(&snapshotMux);
+    memcpy(out, snapshot, SNAPSHOT_SIZE);
+    portEXIT_CRITICAL(&snapshotMux);
+}
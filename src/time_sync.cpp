@@ -0,0 +1,51 @@
+#include "time_sync.h"
+#include "config.h"
+
+static int32_t clampDrift(int64_t driftPpm)
+{
+    if (driftPpm > TIME_SYNC_MAX_DRIFT_PPM) return TIME_SYNC_MAX_DRIFT_PPM;
+    if (driftPpm < -TIME_SYNC_MAX_DRIFT_PPM) return -TIME_SYNC_MAX_DRIFT_PPM;
+    return (int32_t)driftPpm;
+}
+
+void timeSyncInit(TimeSync &sync)
+{
+    sync.valid = false;
+    sync.localAnchor = 0;
+    sync.sharedAnchor = 0;
+    sync.driftPpm = 0;
+}
+
+void timeSyncApply(TimeSync &sync, uint32_t localNow, uint32_t sharedNow, int32_t driftPpm)
+{
+    sync.valid = true;
+    sync.localAnchor = localNow;
+    sync.sharedAnchor = sharedNow;
+    sync.driftPpm = clampDrift(driftPpm);
+}
+
+void timeSyncApplyEstimate(TimeSync &sync, uint32_t localNow, uint32_t sharedNow)
+{
+    int32_t driftPpm = sync.driftPpm;
+    uint32_t elapsed = localNow - sync.localAnchor;
+
+    // Short windows are dominated by BLE delivery jitter, so only re-anchor the offset
+    if (sync.valid && elapsed >= TIME_SYNC_MIN_DRIFT_WINDOW_MS) {
+        int32_t error = (int32_t)(sharedNow - timeSyncNow(sync, localNow));
+        int64_t errorPpm = (int64_t)error * 1000000 / elapsed;
+        driftPpm = clampDrift(driftPpm + errorPpm / TIME_SYNC_DRIFT_GAIN_DIV);
+    }
+
+    timeSyncApply(sync, localNow, sharedNow, driftPpm);
+}
+
+uint32_t timeSyncNow(const TimeSync &sync, uint32_t localNow)
+{
+    if (!sync.valid) {
+        return localNow;
+    }
+
+    uint32_t elapsed = localNow - sync.localAnchor;
+    int64_t correction = (int64_t)elapsed * sync.driftPpm / 1000000;
+    return sync.sharedAnchor + elapsed + (uint32_t)correction;
+}
@@ -0,0 +1,52 @@
+// libFuzzer target for the command parser, outside the PlatformIO test runner. From the project root:
+//   clang++ -std=c++17 -g -fsanitize=fuzzer,address,undefined -Iinclude test/fuzz/fuzz_protocol.cpp src/protocol.cpp src/pixel_formats.cpp -o fuzz_protocol
+#include "protocol.h"
+#include "pixel_formats.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void touch(const uint8_t *pointer, size_t length)
+{
+    // Copying the referenced payload lets the sanitizer catch pointers outside the input
+    static uint8_t scratch[65536];
+    if (pointer != nullptr && length <= sizeof(scratch)) {
+        memcpy(scratch, pointer, length);
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    // Copy into an exact-size heap buffer so reads past the end are reported
+    uint8_t *input = (uint8_t *)malloc(size);
+    if (size > 0) {
+        memcpy(input, data, size);
+    }
+
+    Command command;
+    if (parseCommand(input, size, command) == PARSE_OK) {
+        switch (command.id) {
+            case CMD_SET_COLOR:
+                touch(command.color.color, 4);
+                break;
+            case CMD_SET_COLOR_SETS:
+            case CMD_SET_INDIVIDUAL_COLORS:
+                touch(command.colorList.colors, command.colorList.count * 4);
+                break;
+            case CMD_SET_ANIMATION:
+                touch(command.animation.params, command.animation.paramsLength);
+                break;
+            case CMD_SET_PALETTE:
+                if (command.palette.startIndex + command.palette.count > PALETTE_MAX_COLORS) abort();
+                touch(command.palette.colors, command.palette.count * 4);
+                break;
+            case CMD_SET_INDEXED_COLORS:
+            case CMD_SET_PACKED_COLORS:
+                touch(command.pixels.data, command.pixels.length);
+                break;
+        }
+    }
+
+    free(input);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "../test_support.h"
+#include "adv_policy.h"
+
+#define MAX_CONNECTIONS 2
+#define FAST_BURST_MS 30000
+
+static AdvPolicy policy;
+
+void setUp(void)
+{
+    advPolicyInit(policy, MAX_CONNECTIONS, FAST_BURST_MS, 1000);
+}
+
+void tearDown(void) {}
+
+void test_starts_fast_then_slows_down(void)
+{
+    TEST_ASSERT_EQUAL(ADV_MODE_FAST, policy.mode);
+    TEST_ASSERT_EQUAL(ADV_MODE_FAST, advPolicyUpdate(policy, 1000 + FAST_BURST_MS - 1));
+    TEST_ASSERT_EQUAL(ADV_MODE_SLOW, advPolicyUpdate(policy, 1000 + FAST_BURST_MS));
+    TEST_ASSERT_EQUAL(ADV_MODE_SLOW, advPolicyUpdate(policy, 1000 + 10 * FAST_BURST_MS));
+}
+
+void test_full_server_stops_advertising(void)
+{
+    advPolicyOnConnect(policy, 2000);
+    TEST_ASSERT_EQUAL(ADV_MODE_SLOW, advPolicyUpdate(policy, 2000));
+    advPolicyOnConnect(policy, 3000);
+    TEST_ASSERT_EQUAL(2, policy.connections);
+    TEST_ASSERT_EQUAL(ADV_MODE_OFF, advPolicyUpdate(policy, 3000));
+    TEST_ASSERT_EQUAL(ADV_MODE_OFF, advPolicyUpdate(policy, 3000 + FAST_BURST_MS));
+}
+
+void test_disconnect_restarts_fast_burst(void)
+{
+    advPolicyOnConnect(policy, 2000);
+    advPolicyOnConnect(policy, 3000);
+    advPolicyOnDisconnect(policy, 5000);
+    TEST_ASSERT_EQUAL(1, policy.connections);
+    TEST_ASSERT_EQUAL(ADV_MODE_FAST, advPolicyUpdate(policy, 5000 + FAST_BURST_MS - 1));
+    TEST_ASSERT_EQUAL(ADV_MODE_SLOW, advPolicyUpdate(policy, 5000 + FAST_BURST_MS));
+
+    advPolicyOnDisconnect(policy, 40000);
+    advPolicyOnDisconnect(policy, 41000);
+    TEST_ASSERT_EQUAL(0, policy.connections);
+}
+
+void test_time_to_connect_statistics(void)
+{
+    // Fast: advertising started at boot (1000 ms)
+    advPolicyOnConnect(policy, 1250);
+    TEST_ASSERT_EQUAL_UINT32(1, policy.stats.fastConnects);
+    TEST_ASSERT_EQUAL_UINT32(250, policy.stats.lastTimeToConnectMs);
+
+    // Slow: advertising continued for the free slot from 1250 ms
+    advPolicyUpdate(policy, 1250 + FAST_BURST_MS);
+    advPolicyOnConnect(policy, 1250 + 5000);
+    TEST_ASSERT_EQUAL_UINT32(1, policy.stats.slowConnects);
+    TEST_ASSERT_EQUAL_UINT32(5000, policy.stats.lastTimeToConnectMs);
+    TEST_ASSERT_EQUAL(ADV_MODE_OFF, policy.mode);
+
+    // A disconnect while full restarts the advertising clock
+    advPolicyOnDisconnect(policy, 10000);
+    advPolicyOnConnect(policy, 11100);
+    TEST_ASSERT_EQUAL_UINT32(3, policy.stats.connects);
+    TEST_ASSERT_EQUAL_UINT32(2, policy.stats.fastConnects);
+    TEST_ASSERT_EQUAL_UINT32(1100, policy.stats.lastTimeToConnectMs);
+
+    TEST_ASSERT_EQUAL_UINT32(250, policy.stats.minTimeToConnectMs);
+    TEST_ASSERT_EQUAL_UINT32(5000, policy.stats.maxTimeToConnectMs);
+    TEST_ASSERT_EQUAL_UINT32((250 + 5000 + 1100) / 3, advPolicyAverageTimeToConnect(policy));
+}
+
+void test_average_is_zero_without_connects(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(0, advPolicyAverageTimeToConnect(policy));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_fast_then_slows_down);
+    RUN_TEST(test_full_server_stops_advertising);
+    RUN_TEST(test_disconnect_restarts_fast_burst);
+    RUN_TEST(test_time_to_connect_statistics);
+    RUN_TEST(test_average_is_zero_without_connects);
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+#include "../test_support.h"
+#include "frame_governor.h"
+#include "config.h"
+
+static FrameGovernor governor;
+static uint32_t now;
+
+// Renders one frame as soon as it is due
+static void step(uint8_t delta, bool shown, int batteryPercent)
+{
+    now += governor.intervalMs;
+    TEST_ASSERT_TRUE(frameGovernorDue(governor, now));
+    frameGovernorUpdate(governor, delta, shown, batteryPercent, now);
+}
+
+void setUp(void)
+{
+    now = 1000;
+    frameGovernorInit(governor, now);
+}
+
+void tearDown(void) {}
+
+void test_still_frames_back_off_to_max_interval(void)
+{
+    uint32_t expected = FRAME_INTERVAL_MIN_MS;
+    while (expected < FRAME_INTERVAL_MAX_MS) {
+        step(FRAME_DELTA_LOW - 1, false, 100);
+        expected = expected * 5 / 4 + 1;
+        if (expected > FRAME_INTERVAL_MAX_MS) expected = FRAME_INTERVAL_MAX_MS;
+        TEST_ASSERT_EQUAL_UINT16(expected, governor.intervalMs);
+    }
+    step(0, false, 100);
+    TEST_ASSERT_EQUAL_UINT16(FRAME_INTERVAL_MAX_MS, governor.intervalMs);
+}
+
+void test_fast_motion_halves_interval(void)
+{
+    governor.intervalMs = FRAME_INTERVAL_MAX_MS;
+    step(FRAME_DELTA_HIGH + 1, true, 100);
+    TEST_ASSERT_EQUAL_UINT16(FRAME_INTERVAL_MAX_MS / 2, governor.intervalMs);
+    step(255, true, 100);
+    TEST_ASSERT_EQUAL_UINT16(FRAME_INTERVAL_MAX_MS / 4, governor.intervalMs);
+    for (int i = 0; i < 8; i++) {
+        step(255, true, 100);
+    }
+    TEST_ASSERT_EQUAL_UINT16(FRAME_INTERVAL_MIN_MS, governor.intervalMs);
+}
+
+void test_moderate_change_holds_interval(void)
+{
+    governor.intervalMs = 50;
+    step(FRAME_DELTA_LOW, true, 100);
+    step(FRAME_DELTA_HIGH, true, 100);
+    TEST_ASSERT_EQUAL_UINT16(50, governor.intervalMs);
+}
+
+void test_low_battery_floors_interval(void)
+{
+    step(255, true, GOVERNOR_LOW_BATTERY_PERCENT);
+    TEST_ASSERT_EQUAL_UINT16(FRAME_INTERVAL_LOW_BATTERY_MS, governor.intervalMs);
+    step(255, true, GOVERNOR_LOW_BATTERY_PERCENT);
+    TEST_ASSERT_EQUAL_UINT16(FRAME_INTERVAL_LOW_BATTERY_MS, governor.intervalMs);
+
+    // Back above the threshold the full rate is allowed again
+    step(255, true, GOVERNOR_LOW_BATTERY_PERCENT + 1);
+    TEST_ASSERT_EQUAL_UINT16(FRAME_INTERVAL_LOW_BATTERY_MS / 2, governor.intervalMs);
+}
+
+void test_counts_shown_and_dropped_frames(void)
+{
+    step(10, true, 100);
+    step(0, false, 100);
+    step(0, false, 100);
+    TEST_ASSERT_EQUAL_UINT32(3, governor.rendered);
+    TEST_ASSERT_EQUAL_UINT32(1, governor.shown);
+    TEST_ASSERT_EQUAL_UINT32(2, governor.dropped);
+}
+
+void test_not_due_before_interval(void)
+{
+    governor.intervalMs = 40;
+    TEST_ASSERT_FALSE(frameGovernorDue(governor, now + 39));
+    TEST_ASSERT_TRUE(frameGovernorDue(governor, now + 40));
+}
+
+void test_effective_fps_over_one_second_window(void)
+{
+    governor.intervalMs = 50;
+    for (int i = 0; i < 20; i++) {
+        step(FRAME_DELTA_LOW, i % 2 == 0, 100);
+    }
+    TEST_ASSERT_EQUAL_UINT16(100, governor.effectiveFpsX10);
+}
+
+void test_idle_resets_window(void)
+{
+    governor.intervalMs = 50;
+    for (int i = 0; i < 20; i++) {
+        step(FRAME_DELTA_LOW, true, 100);
+    }
+    TEST_ASSERT_EQUAL_UINT16(200, governor.effectiveFpsX10);
+
+    frameGovernorIdle(governor, now + 5000);
+    TEST_ASSERT_EQUAL_UINT16(0, governor.effectiveFpsX10);
+    TEST_ASSERT_EQUAL_UINT32(0, governor.windowShown);
+    TEST_ASSERT_EQUAL_UINT32(now + 5000, governor.windowStartMs);
+
+    // The idle gap must not dilute the next animation's first window
+    now += 5000;
+    for (int i = 0; i < 20; i++) {
+        step(FRAME_DELTA_LOW, true, 100);
+    }
+    TEST_ASSERT_EQUAL_UINT16(200, governor.effectiveFpsX10);
+}
+
+void test_frame_delta_is_largest_channel_change(void)
+{
+    const uint8_t previous[] = {0, 100, 200, 255, 7, 7, 7, 7};
+    const uint8_t current[] = {3, 95, 200, 254, 7, 7, 7, 7};
+    TEST_ASSERT_EQUAL_UINT8(5, frameDelta(current, previous, sizeof(current)));
+    TEST_ASSERT_EQUAL_UINT8(0, frameDelta(previous, previous, sizeof(previous)));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_still_frames_back_off_to_max_interval);
+    RUN_TEST(test_fast_motion_halves_interval);
+    RUN_TEST(test_moderate_change_holds_interval);
+    RUN_TEST(test_low_battery_floors_interval);
+    RUN_TEST(test_counts_shown_and_dropped_frames);
+    RUN_TEST(test_not_due_before_interval);
+    RUN_TEST(test_effective_fps_over_one_second_window);
+    RUN_TEST(test_idle_resets_window);
+    RUN_TEST(test_frame_delta_is_largest_channel_change);
+    return UNITY_END();
+}
@@ -0,0 +1,117 @@
+#include "../test_support.h"
+#include "link_policy.h"
+#include "config.h"
+
+static LinkPolicy policy;
+
+void setUp(void)
+{
+    linkPolicyInit(policy, 1000);
+}
+
+void tearDown(void) {}
+
+void test_starts_fast_for_discovery(void)
+{
+    TEST_ASSERT_EQUAL(LINK_STREAMING, policy.workload);
+}
+
+void test_goes_idle_after_timeout(void)
+{
+    TEST_ASSERT_FALSE(linkPolicyUpdate(policy, 1000 + LINK_IDLE_TIMEOUT_MS - 1));
+    TEST_ASSERT_EQUAL(LINK_STREAMING, policy.workload);
+    TEST_ASSERT_TRUE(linkPolicyUpdate(policy, 1000 + LINK_IDLE_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL(LINK_IDLE, policy.workload);
+    TEST_ASSERT_FALSE(linkPolicyUpdate(policy, 1000 + 2 * LINK_IDLE_TIMEOUT_MS));
+}
+
+void test_sparse_writes_stay_idle(void)
+{
+    uint32_t now = 1000 + LINK_IDLE_TIMEOUT_MS;
+    linkPolicyUpdate(policy, now);
+    for (int i = 0; i < 10; i++) {
+        now += LINK_STREAM_WINDOW_MS;
+        linkPolicyOnWrite(policy, false, now);
+        TEST_ASSERT_EQUAL(LINK_IDLE, policy.workload);
+    }
+}
+
+void test_burst_of_writes_streams(void)
+{
+    uint32_t now = 1000 + LINK_IDLE_TIMEOUT_MS;
+    linkPolicyUpdate(policy, now);
+    for (int i = 0; i < LINK_STREAM_MIN_WRITES - 1; i++) {
+        linkPolicyOnWrite(policy, false, now + i * 10);
+        TEST_ASSERT_EQUAL(LINK_IDLE, policy.workload);
+    }
+    linkPolicyOnWrite(policy, false, now + LINK_STREAM_MIN_WRITES * 10);
+    TEST_ASSERT_EQUAL(LINK_STREAMING, policy.workload);
+}
+
+void test_streaming_keeps_link_fast(void)
+{
+    // Writes at the streaming threshold keep refreshing the idle timer
+    uint32_t interval = LINK_STREAM_WINDOW_MS / LINK_STREAM_MIN_WRITES;
+    uint32_t now = 1000;
+    for (int i = 0; i < 100; i++) {
+        now += interval;
+        linkPolicyOnWrite(policy, false, now);
+        TEST_ASSERT_FALSE(linkPolicyUpdate(policy, now));
+    }
+    TEST_ASSERT_EQUAL(LINK_STREAMING, policy.workload);
+}
+
+void test_bulk_write_takes_precedence(void)
+{
+    linkPolicyOnWrite(policy, true, 1100);
+    TEST_ASSERT_EQUAL(LINK_BULK, policy.workload);
+    // Light commands during an upload do not downgrade it
+    for (int i = 0; i < 2 * LINK_STREAM_MIN_WRITES; i++) {
+        linkPolicyOnWrite(policy, false, 1200 + i);
+    }
+    TEST_ASSERT_EQUAL(LINK_BULK, policy.workload);
+    TEST_ASSERT_TRUE(linkPolicyUpdate(policy, 1200 + 2 * LINK_STREAM_MIN_WRITES + LINK_IDLE_TIMEOUT_MS));
+    TEST_ASSERT_EQUAL(LINK_IDLE, policy.workload);
+}
+
+void test_survives_millis_rollover(void)
+{
+    linkPolicyInit(policy, 0xFFFFFF00u);
+    linkPolicyOnWrite(policy, true, 0xFFFFFFF0u);
+    TEST_ASSERT_FALSE(linkPolicyUpdate(policy, 0x00000100u));
+    TEST_ASSERT_EQUAL(LINK_BULK, policy.workload);
+}
+
+void test_parameters_follow_ios_guidelines(void)
+{
+    const LinkWorkload workloads[] = {LINK_IDLE, LINK_STREAMING, LINK_BULK};
+    for (LinkWorkload workload : workloads) {
+        const LinkParams &params = linkParamsFor(workload);
+        uint32_t minMs = params.minInterval * 5 / 4;
+        uint32_t maxMs = params.maxInterval * 5 / 4;
+        uint32_t timeoutMs = params.timeout * 10;
+
+        TEST_ASSERT_GREATER_OR_EQUAL(15, minMs);
+        TEST_ASSERT_TRUE(maxMs == 15 || minMs + 15 <= maxMs);
+        TEST_ASSERT_LESS_OR_EQUAL(30, params.latency);
+        TEST_ASSERT_LESS_OR_EQUAL(2000, maxMs * (params.latency + 1));
+        TEST_ASSERT_TRUE(timeoutMs >= 2000 && timeoutMs <= 6000);
+        TEST_ASSERT_TRUE(maxMs * (params.latency + 1) * 3 < timeoutMs);
+    }
+    TEST_ASSERT_TRUE(linkParamsFor(LINK_STREAMING).phy2M);
+    TEST_ASSERT_FALSE(linkParamsFor(LINK_IDLE).phy2M);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_fast_for_discovery);
+    RUN_TEST(test_goes_idle_after_timeout);
+    RUN_TEST(test_sparse_writes_stay_idle);
+    RUN_TEST(test_burst_of_writes_streams);
+    RUN_TEST(test_streaming_keeps_link_fast);
+    RUN_TEST(test_bulk_write_takes_precedence);
+    RUN_TEST(test_survives_millis_rollover);
+    RUN_TEST(test_parameters_follow_ios_guidelines);
+    return UNITY_END();
+}
@@ -0,0 +1,250 @@
+#include "../test_support.h"
+#include "ota_session.h"
+#include <string.h>
+
+// Simulated link and flash timing, one connection event every SIM_INTERVAL_MS
+#define SIM_IMAGE_SIZE (512 * 1024)
+#define SIM_INTERVAL_MS 15
+#define SIM_CHUNKS_PER_EVENT 6
+#define SIM_SECTOR_WRITE_MS 25
+#define SIM_RESEND_TIMEOUT_MS 1000
+#define SIM_TIME_LIMIT_MS 120000
+
+static const uint8_t fakeHash[OTA_HASH_SIZE] = {0xFA, 0x4E};
+
+// Flash backend that keeps the image in RAM and charges a fixed time per write
+class FakeFlashBackend : public OtaFlashBackend
+{
+public:
+    bool begin(uint32_t imageSize) override
+    {
+        if (imageSize > sizeof(flash)) {
+            return false;
+        }
+        length = 0;
+        active = true;
+        begins++;
+        return true;
+    }
+
+    bool write(const uint8_t *data, size_t size) override
+    {
+        if (failWrites || length + size > sizeof(flash)) {
+            return false;
+        }
+        memcpy(flash + length, data, size);
+        length += size;
+        busyMs += SIM_SECTOR_WRITE_MS;
+        return true;
+    }
+
+    bool finish(const uint8_t *expectedHash) override
+    {
+        active = false;
+        return memcmp(expectedHash, fakeHash, OTA_HASH_SIZE) == 0;
+    }
+
+    void abort() override
+    {
+        active = false;
+        aborts++;
+    }
+
+    uint8_t flash[SIM_IMAGE_SIZE];
+    size_t length = 0;
+    bool active = false;
+    bool failWrites = false;
+    int begins = 0;
+    int aborts = 0;
+    uint32_t busyMs = 0;
+};
+
+static FakeFlashBackend backend;
+static OtaSession session;
+static uint8_t image[SIM_IMAGE_SIZE];
+static size_t buildChunk(uint8_t *out, uint16_t seq, uint32_t offset)
+{
+    uint32_t remaining = SIM_IMAGE_SIZE - offset;
+    size_t length = remaining < OTA_CHUNK_MAX ? remaining : OTA_CHUNK_MAX;
+    out[0] = seq >> 8;
+    out[1] = seq & 0xFF;
+    memcpy(out + 2, image + offset, length);
+    return length + 2;
+}
+
+// Windowed sender against the session, returns the session throughput in bytes/s
+static uint32_t runTransfer(uint32_t dropPerMille)
+{
+    if (otaSessionBegin(session, SIM_IMAGE_SIZE, fakeHash, 0) != OTA_STATUS_READY) {
+        return 0;
+    }
+
+    uint16_t base = 0;
+    uint16_t next = 0;
+    uint32_t lastProgress = 0;
+    uint32_t loopFreeAt = 0;
+    bool pendingNack = false;
+    uint16_t nackSeq = 0;
+    bool pendingAck = false;
+    uint16_t ackSeq = 0;
+    uint8_t chunk[2 + OTA_CHUNK_MAX];
+
+    for (uint32_t now = 0; now < SIM_TIME_LIMIT_MS; now++) {
+        if (now % SIM_INTERVAL_MS == 0) {
+            // Notifications queued since the last event reach the sender first
+            if (pendingAck) {
+                base = ackSeq;
+                lastProgress = now;
+                pendingAck = false;
+            }
+            if (pendingNack) {
+                next = nackSeq;
+                pendingNack = false;
+            }
+            if (now - lastProgress >= SIM_RESEND_TIMEOUT_MS) {
+                next = base;
+                lastProgress = now;
+            }
+
+            for (int i = 0; i < SIM_CHUNKS_PER_EVENT; i++) {
+                uint32_t offset = (uint32_t)next * OTA_CHUNK_MAX;
+                if ((uint16_t)(next - base) >= OTA_WINDOW_CHUNKS || offset >= SIM_IMAGE_SIZE) {
+                    break;
+                }
+                size_t length = buildChunk(chunk, next, offset);
+                next++;
+                if (testRandom() % 1000 < dropPerMille) {
+                    continue;
+                }
+                if (otaSessionReceive(session, chunk, length) == OTA_STATUS_NACK) {
+                    pendingNack = true;
+                    nackSeq = session.nextSeq;
+                }
+            }
+        }
+
+        // loop() is blocked while a sector is written
+        if (now < loopFreeAt) {
+            continue;
+        }
+        uint32_t busyBefore = backend.busyMs;
+        OtaStatus status = otaSessionService(session, now);
+        loopFreeAt = now + (backend.busyMs - busyBefore);
+
+        if (status == OTA_STATUS_ACK) {
+            pendingAck = true;
+            ackSeq = session.ackedSeq;
+        } else if (status == OTA_STATUS_DONE || status == OTA_STATUS_ERROR) {
+            break;
+        }
+    }
+
+    return otaSessionThroughput(session);
+}
+
+static void reportThroughput(const char *label, uint32_t bytesPerSecond)
+{
+    TEST_REPORT("%s: %.1f KB/s", label, bytesPerSecond / 1024.0);
+}
+
+void setUp(void)
+{
+    testSeedRandom(1);
+    for (uint32_t i = 0; i < SIM_IMAGE_SIZE; i++) {
+        image[i] = (uint8_t)(testRandom() >> 4);
+    }
+    memset(backend.flash, 0, sizeof(backend.flash));
+    backend.failWrites = false;
+    backend.begins = 0;
+    backend.aborts = 0;
+    backend.busyMs = 0;
+    otaSessionInit(session, &backend);
+}
+
+void tearDown(void) {}
+
+void test_clean_link_throughput(void)
+{
+    uint32_t bytesPerSecond = runTransfer(0);
+    reportThroughput("clean link", bytesPerSecond);
+    TEST_ASSERT_EQUAL(OTA_DONE, session.state.load());
+    TEST_ASSERT_EQUAL(SIM_IMAGE_SIZE, backend.length);
+    TEST_ASSERT_EQUAL_MEMORY(image, backend.flash, SIM_IMAGE_SIZE);
+    TEST_ASSERT_GREATER_OR_EQUAL(60 * 1024, bytesPerSecond);
+}
+
+void test_lossy_link_recovers(void)
+{
+    uint32_t bytesPerSecond = runTransfer(10);
+    reportThroughput("1% chunk loss", bytesPerSecond);
+    TEST_ASSERT_EQUAL(OTA_DONE, session.state.load());
+    TEST_ASSERT_EQUAL_MEMORY(image, backend.flash, SIM_IMAGE_SIZE);
+    TEST_ASSERT_GREATER_OR_EQUAL(30 * 1024, bytesPerSecond);
+}
+
+void test_out_of_order_chunk_nacks_once(void)
+{
+    uint8_t chunk[2 + OTA_CHUNK_MAX];
+    TEST_ASSERT_EQUAL(OTA_STATUS_READY, otaSessionBegin(session, SIM_IMAGE_SIZE, fakeHash, 0));
+    TEST_ASSERT_EQUAL(OTA_STATUS_NONE, otaSessionReceive(session, chunk, buildChunk(chunk, 0, 0)));
+    TEST_ASSERT_EQUAL(OTA_STATUS_NACK, otaSessionReceive(session, chunk, buildChunk(chunk, 2, 2 * OTA_CHUNK_MAX)));
+    TEST_ASSERT_EQUAL(OTA_STATUS_NONE, otaSessionReceive(session, chunk, buildChunk(chunk, 3, 3 * OTA_CHUNK_MAX)));
+    TEST_ASSERT_EQUAL_UINT16(1, session.nextSeq.load());
+    TEST_ASSERT_EQUAL(OTA_STATUS_NONE, otaSessionReceive(session, chunk, buildChunk(chunk, 1, OTA_CHUNK_MAX)));
+    TEST_ASSERT_EQUAL_UINT16(2, session.nextSeq.load());
+}
+
+void test_oversized_chunk_is_rejected(void)
+{
+    uint8_t chunk[3 + OTA_CHUNK_MAX] = {0};
+    TEST_ASSERT_EQUAL(OTA_STATUS_READY, otaSessionBegin(session, SIM_IMAGE_SIZE, fakeHash, 0));
+    TEST_ASSERT_EQUAL(OTA_STATUS_ERROR, otaSessionReceive(session, chunk, sizeof(chunk)));
+    TEST_ASSERT_EQUAL_UINT16(0, session.nextSeq.load());
+}
+
+void test_flash_failure_aborts_backend(void)
+{
+    backend.failWrites = true;
+    runTransfer(0);
+    TEST_ASSERT_EQUAL(OTA_FAILED, session.state.load());
+    TEST_ASSERT_EQUAL(1, backend.aborts);
+    TEST_ASSERT_FALSE(backend.active);
+}
+
+void test_bad_hash_fails(void)
+{
+    uint8_t wrongHash[OTA_HASH_SIZE] = {0};
+    uint8_t chunk[2 + OTA_CHUNK_MAX];
+    TEST_ASSERT_EQUAL(OTA_STATUS_READY, otaSessionBegin(session, 100, wrongHash, 0));
+    memcpy(chunk + 2, image, 100);
+    chunk[0] = 0;
+    chunk[1] = 0;
+    TEST_ASSERT_EQUAL(OTA_STATUS_NONE, otaSessionReceive(session, chunk, 102));
+    TEST_ASSERT_EQUAL(OTA_STATUS_ERROR, otaSessionService(session, 10));
+    TEST_ASSERT_EQUAL(OTA_FAILED, session.state.load());
+}
+
+void test_restart_resets_transfer(void)
+{
+    uint8_t chunk[2 + OTA_CHUNK_MAX];
+    TEST_ASSERT_EQUAL(OTA_STATUS_READY, otaSessionBegin(session, SIM_IMAGE_SIZE, fakeHash, 0));
+    TEST_ASSERT_EQUAL(OTA_STATUS_NONE, otaSessionReceive(session, chunk, buildChunk(chunk, 0, 0)));
+    TEST_ASSERT_EQUAL(OTA_STATUS_READY, otaSessionBegin(session, SIM_IMAGE_SIZE, fakeHash, 0));
+    TEST_ASSERT_EQUAL(1, backend.aborts);
+    TEST_ASSERT_EQUAL(2, backend.begins);
+    TEST_ASSERT_EQUAL_UINT16(0, session.nextSeq.load());
+    TEST_ASSERT_EQUAL_UINT32(0, session.received);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_link_throughput);
+    RUN_TEST(test_lossy_link_recovers);
+    RUN_TEST(test_out_of_order_chunk_nacks_once);
+    RUN_TEST(test_oversized_chunk_is_rejected);
+    RUN_TEST(test_flash_failure_aborts_backend);
+    RUN_TEST(test_bad_hash_fails);
+    RUN_TEST(test_restart_resets_transfer);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+#include "../test_support.h"
+#include "pixel_formats.h"
+#include <string.h>
+
+#define FRAME_PIXELS 8
+#define UNTOUCHED 0xEE
+
+static uint8_t frame[FRAME_PIXELS * 4];
+static uint8_t palette[PALETTE_MAX_COLORS][4];
+
+static void assertPixel(size_t pixel, uint8_t r, uint8_t g, uint8_t b, uint8_t w)
+{
+    const uint8_t expected[4] = {r, g, b, w};
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, frame + pixel * 4, 4);
+}
+
+static void assertUntouched(size_t pixel)
+{
+    assertPixel(pixel, UNTOUCHED, UNTOUCHED, UNTOUCHED, UNTOUCHED);
+}
+
+void setUp(void)
+{
+    memset(frame, UNTOUCHED, sizeof(frame));
+    // Entry i is {i, i, i, 255 - i} so every index is recognizable in the frame
+    for (int i = 0; i < PALETTE_MAX_COLORS; i++) {
+        palette[i][0] = i;
+        palette[i][1] = i;
+        palette[i][2] = i;
+        palette[i][3] = 255 - i;
+    }
+}
+
+void tearDown(void) {}
+
+void test_indexed_8bpp_maps_bytes_in_order(void)
+{
+    const uint8_t data[] = {0x00, 0x80, 0xFF};
+    TEST_ASSERT_EQUAL(3, decodeIndexedPixels(frame, FRAME_PIXELS, 1, data, sizeof(data), 8, palette));
+    assertUntouched(0);
+    assertPixel(1, 0x00, 0x00, 0x00, 0xFF);
+    assertPixel(2, 0x80, 0x80, 0x80, 0x7F);
+    assertPixel(3, 0xFF, 0xFF, 0xFF, 0x00);
+    assertUntouched(4);
+}
+
+void test_indexed_4bpp_is_high_nibble_first(void)
+{
+    const uint8_t data[] = {0x12, 0x3F};
+    TEST_ASSERT_EQUAL(4, decodeIndexedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data), 4, palette));
+    assertPixel(0, 1, 1, 1, 254);
+    assertPixel(1, 2, 2, 2, 253);
+    assertPixel(2, 3, 3, 3, 252);
+    assertPixel(3, 15, 15, 15, 240);
+    assertUntouched(4);
+}
+
+void test_indexed_odd_count_skips_padding_nibble(void)
+{
+    const uint8_t data[] = {0x12, 0x30};
+    TEST_ASSERT_EQUAL(3, decodeIndexedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data),
+                                             4 | INDEXED_ODD_COUNT, palette));
+    assertPixel(2, 3, 3, 3, 252);
+    assertUntouched(3);
+}
+
+void test_indexed_rejects_unknown_depths(void)
+{
+    const uint8_t data[] = {0x12};
+    TEST_ASSERT_EQUAL(0, decodeIndexedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data), 2, palette));
+    TEST_ASSERT_EQUAL(0, decodeIndexedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data),
+                                             8 | INDEXED_ODD_COUNT, palette));
+    TEST_ASSERT_EQUAL(0, indexedPixelCount(4 | INDEXED_ODD_COUNT, 0));
+    assertUntouched(0);
+}
+
+void test_indexed_clamps_at_frame_end(void)
+{
+    const uint8_t data[] = {0x12, 0x34, 0x56};
+    TEST_ASSERT_EQUAL(2, decodeIndexedPixels(frame, FRAME_PIXELS, FRAME_PIXELS - 2, data, sizeof(data), 4, palette));
+    assertUntouched(FRAME_PIXELS - 3);
+    assertPixel(FRAME_PIXELS - 2, 1, 1, 1, 254);
+    assertPixel(FRAME_PIXELS - 1, 2, 2, 2, 253);
+    TEST_ASSERT_EQUAL(0, decodeIndexedPixels(frame, FRAME_PIXELS, FRAME_PIXELS, data, sizeof(data), 8, palette));
+}
+
+void test_rgb565_expands_to_full_range(void)
+{
+    const uint8_t data[] = {0xFF, 0xFF, 0x00, 0x00, 0xF8, 0x00, 0x07, 0xE0, 0x00, 0x1F, 0x84, 0x10};
+    TEST_ASSERT_EQUAL(6, decodePackedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data), PIXEL_FORMAT_RGB565));
+    assertPixel(0, 0xFF, 0xFF, 0xFF, 0);
+    assertPixel(1, 0x00, 0x00, 0x00, 0);
+    assertPixel(2, 0xFF, 0x00, 0x00, 0);
+    assertPixel(3, 0x00, 0xFF, 0x00, 0);
+    assertPixel(4, 0x00, 0x00, 0xFF, 0);
+    assertPixel(5, 0x84, 0x82, 0x84, 0);
+}
+
+void test_rgb332_expands_to_full_range(void)
+{
+    const uint8_t data[] = {0xFF, 0x00, 0xE0, 0x1C, 0x03, 0x49};
+    TEST_ASSERT_EQUAL(6, decodePackedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data), PIXEL_FORMAT_RGB332));
+    assertPixel(0, 0xFF, 0xFF, 0xFF, 0);
+    assertPixel(1, 0x00, 0x00, 0x00, 0);
+    assertPixel(2, 0xFF, 0x00, 0x00, 0);
+    assertPixel(3, 0x00, 0xFF, 0x00, 0);
+    assertPixel(4, 0x00, 0x00, 0xFF, 0);
+    assertPixel(5, 0x49, 0x49, 0x55, 0);
+}
+
+void test_rgbw4444_expands_each_nibble(void)
+{
+    const uint8_t data[] = {0xF0, 0x00, 0x0F, 0x00, 0x00, 0xF0, 0x00, 0x0F, 0x12, 0x34};
+    TEST_ASSERT_EQUAL(5, decodePackedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data), PIXEL_FORMAT_RGBW4444));
+    assertPixel(0, 0xFF, 0x00, 0x00, 0x00);
+    assertPixel(1, 0x00, 0xFF, 0x00, 0x00);
+    assertPixel(2, 0x00, 0x00, 0xFF, 0x00);
+    assertPixel(3, 0x00, 0x00, 0x00, 0xFF);
+    assertPixel(4, 0x11, 0x22, 0x33, 0x44);
+}
+
+void test_packed_clamps_at_frame_end(void)
+{
+    const uint8_t formats[] = {PIXEL_FORMAT_RGB565, PIXEL_FORMAT_RGB332, PIXEL_FORMAT_RGBW4444};
+    uint8_t data[4 * 2];
+    memset(data, 0xFF, sizeof(data));
+
+    for (uint8_t format : formats) {
+        setUp();
+        size_t length = 4 * packedPixelSize(format);
+        TEST_ASSERT_EQUAL(3, decodePackedPixels(frame, FRAME_PIXELS, FRAME_PIXELS - 3, data, length, format));
+        assertUntouched(FRAME_PIXELS - 4);
+        TEST_ASSERT_EQUAL_HEX8(0xFF, frame[(FRAME_PIXELS - 1) * 4]);
+        TEST_ASSERT_EQUAL(0, decodePackedPixels(frame, FRAME_PIXELS, FRAME_PIXELS, data, length, format));
+    }
+    TEST_ASSERT_EQUAL(0, decodePackedPixels(frame, FRAME_PIXELS, 0, data, sizeof(data), 0x7F));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_indexed_8bpp_maps_bytes_in_order);
+    RUN_TEST(test_indexed_4bpp_is_high_nibble_first);
+    RUN_TEST(test_indexed_odd_count_skips_padding_nibble);
+    RUN_TEST(test_indexed_rejects_unknown_depths);
+    RUN_TEST(test_indexed_clamps_at_frame_end);
+    RUN_TEST(test_rgb565_expands_to_full_range);
+    RUN_TEST(test_rgb332_expands_to_full_range);
+    RUN_TEST(test_rgbw4444_expands_each_nibble);
+    RUN_TEST(test_packed_clamps_at_frame_end);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+#include "../test_support.h"
+#include "power_budget.h"
+#include "config.h"
+#include <string.h>
+
+#define BENCH_PIXELS 300
+#define BENCH_ITERATIONS 20000
+
+static uint8_t frame[1024 * 4 + 1];
+static uint8_t reference[1024 * 4 + 1];
+static void referenceSums(const uint8_t *data, size_t pixels, FrameChannelSums &sums)
+{
+    sums = {0, 0, 0, 0};
+    for (size_t i = 0; i < pixels; i++) {
+        sums.r += data[i * 4 + 0];
+        sums.g += data[i * 4 + 1];
+        sums.b += data[i * 4 + 2];
+        sums.w += data[i * 4 + 3];
+    }
+}
+
+static void assertSumsMatch(const uint8_t *data, size_t pixels)
+{
+    FrameChannelSums expected, actual;
+    referenceSums(data, pixels, expected);
+    sumFrameChannels(data, pixels, actual);
+    TEST_ASSERT_EQUAL_UINT32(expected.r, actual.r);
+    TEST_ASSERT_EQUAL_UINT32(expected.g, actual.g);
+    TEST_ASSERT_EQUAL_UINT32(expected.b, actual.b);
+    TEST_ASSERT_EQUAL_UINT32(expected.w, actual.w);
+}
+
+void setUp(void)
+{
+    testSeedRandom(1);
+}
+
+void tearDown(void) {}
+
+void test_sums_match_reference(void)
+{
+    const size_t sizes[] = {0, 1, 5, 255, 256, 257, 300, 1024};
+    for (size_t size : sizes) {
+        testFillRandom(frame, size * 4);
+        assertSumsMatch(frame, size);
+    }
+}
+
+void test_sums_handle_unaligned_frames(void)
+{
+    testFillRandom(frame, sizeof(frame));
+    assertSumsMatch(frame + 1, 1023);
+}
+
+void test_frame_under_budget_is_untouched(void)
+{
+    memset(frame, 0, NUM_LEDS * 4);
+    frame[0] = 10;
+    memcpy(reference, frame, NUM_LEDS * 4);
+    uint32_t estimateMa = 0;
+    TEST_ASSERT_EQUAL_UINT16(256, limitFramePower(frame, NUM_LEDS, POWER_BUDGET_MA, &estimateMa));
+    TEST_ASSERT_EQUAL_MEMORY(reference, frame, NUM_LEDS * 4);
+    TEST_ASSERT_EQUAL_UINT32(estimateFrameCurrent(frame, NUM_LEDS), estimateMa);
+}
+
+void test_scale_applies_to_every_channel(void)
+{
+    for (int round = 0; round < 50; round++) {
+        testFillRandom(frame, BENCH_PIXELS * 4);
+        memcpy(reference, frame, BENCH_PIXELS * 4);
+        uint32_t budgetMa = 20 + testRandom() % 2000;
+
+        uint16_t scale = limitFramePower(frame, BENCH_PIXELS, budgetMa, nullptr);
+        if (scale == 256) {
+            continue;
+        }
+        for (size_t i = 0; i < BENCH_PIXELS * 4; i++) {
+            TEST_ASSERT_EQUAL_UINT8((reference[i] * scale) >> 8, frame[i]);
+        }
+    }
+}
+
+void test_limited_frame_fits_budget(void)
+{
+    const uint32_t budgets[] = {POWER_BUDGET_MIN_MA, 150, POWER_BUDGET_MA, 1000};
+    for (uint32_t budgetMa : budgets) {
+        memset(frame, 0xFF, BENCH_PIXELS * 4);
+        limitFramePower(frame, BENCH_PIXELS, budgetMa, nullptr);
+        uint32_t idleMa = BENCH_PIXELS * LED_CURRENT_IDLE_UA / 1000;
+        uint32_t expectedMa = budgetMa > idleMa ? budgetMa : idleMa;
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(expectedMa, estimateFrameCurrent(frame, BENCH_PIXELS));
+    }
+}
+
+void test_budget_tightens_with_battery(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(POWER_BUDGET_MA, powerBudgetForBattery(100));
+    TEST_ASSERT_EQUAL_UINT32(POWER_BUDGET_MA, powerBudgetForBattery(POWER_BUDGET_FULL_PERCENT));
+    TEST_ASSERT_EQUAL_UINT32(POWER_BUDGET_MIN_MA, powerBudgetForBattery(0));
+    TEST_ASSERT_EQUAL_UINT32(POWER_BUDGET_MIN_MA, powerBudgetForBattery(-1));
+    uint32_t previous = powerBudgetForBattery(0);
+    for (int percent = 1; percent <= 100; percent++) {
+        uint32_t budget = powerBudgetForBattery(percent);
+        TEST_ASSERT_TRUE(budget >= previous);
+        previous = budget;
+    }
+}
+
+void test_benchmark_estimator(void)
+{
+    testFillRandom(reference, BENCH_PIXELS * 4);
+    FrameChannelSums sums;
+    volatile uint32_t sink = 0;
+
+    double sumNs = testNanosPerCall(BENCH_ITERATIONS, [&]() {
+        sumFrameChannels(reference, BENCH_PIXELS, sums);
+        sink = sink + sums.r;
+    });
+    double limitNs = testNanosPerCall(BENCH_ITERATIONS, [&]() {
+        memcpy(frame, reference, BENCH_PIXELS * 4);
+        limitFramePower(frame, BENCH_PIXELS, POWER_BUDGET_MIN_MA, nullptr);
+    });
+
+    TEST_REPORT("%d pixels: sumFrameChannels %.0f ns, limitFramePower %.0f ns",
+                BENCH_PIXELS, sumNs, limitNs);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sums_match_reference);
+    RUN_TEST(test_sums_handle_unaligned_frames);
+    RUN_TEST(test_frame_under_budget_is_untouched);
+    RUN_TEST(test_scale_applies_to_every_channel);
+    RUN_TEST(test_limited_frame_fits_budget);
+    RUN_TEST(test_budget_tightens_with_battery);
+    RUN_TEST(test_benchmark_estimator);
+    return UNITY_END();
+}
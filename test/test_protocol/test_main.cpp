@@ -0,0 +1,152 @@
+#include "../test_support.h"
+#include "protocol.h"
+#include "config.h"
+#include "pixel_formats.h"
+#include <string.h>
+
+#define FUZZ_ITERATIONS 1000000
+#define FUZZ_MAX_LENGTH 1100 // Past the largest bounded command (CMD_SET_PALETTE)
+#define BENCH_ITERATIONS 2000000
+
+static uint8_t input[FUZZ_MAX_LENGTH];
+static bool inside(const uint8_t *pointer, size_t length, const uint8_t *data, size_t dataLength)
+{
+    return pointer >= data && pointer + length <= data + dataLength;
+}
+
+// Every accepted command must describe a payload inside the input and agree with its descriptor
+static bool commandIsConsistent(const uint8_t *data, size_t length, const Command &command)
+{
+    const CommandDescriptor *descriptor = commandDescriptor(command.id);
+    if (descriptor == nullptr || command.id != data[0] || length < descriptor->minLength ||
+        (descriptor->maxLength != 0 && length > descriptor->maxLength)) {
+        return false;
+    }
+
+    switch (command.id) {
+        case CMD_SET_COLOR:
+            return inside(command.color.color, 4, data, length);
+        case CMD_SET_COLOR_SETS:
+        case CMD_SET_INDIVIDUAL_COLORS:
+            return command.colorList.count > 0 &&
+                   inside(command.colorList.colors, command.colorList.count * 4, data, length);
+        case CMD_SET_ANIMATION:
+            return command.animation.paramsLength == length - 3 &&
+                   (command.animation.params == nullptr ||
+                    inside(command.animation.params, command.animation.paramsLength, data, length));
+        case CMD_SET_TIME_SYNC:
+            return command.timeSync.hasDrift == (length == 7);
+        case CMD_SET_PALETTE:
+            return command.palette.startIndex + command.palette.count <= PALETTE_MAX_COLORS &&
+                   inside(command.palette.colors, command.palette.count * 4, data, length);
+        case CMD_SET_INDEXED_COLORS:
+            return indexedPixelCount(command.pixels.format, command.pixels.length) != 0 &&
+                   inside(command.pixels.data, command.pixels.length, data, length);
+        case CMD_SET_PACKED_COLORS:
+            return packedPixelSize(command.pixels.format) != 0 &&
+                   command.pixels.length % packedPixelSize(command.pixels.format) == 0 &&
+                   inside(command.pixels.data, command.pixels.length, data, length);
+        default:
+            return true;
+    }
+}
+
+void setUp(void)
+{
+    testSeedRandom(1);
+}
+
+void tearDown(void) {}
+
+void test_known_commands_parse(void)
+{
+    Command command;
+    const uint8_t setColor[] = {CMD_SET_COLOR, 1, 2, 3, 4};
+    TEST_ASSERT_EQUAL(PARSE_OK, parseCommand(setColor, sizeof(setColor), command));
+    TEST_ASSERT_TRUE(command.color.color == setColor + 1);
+
+    const uint8_t timeSync[] = {CMD_SET_TIME_SYNC, 0x00, 0x0F, 0x42, 0x40, 0xFF, 0x6A};
+    TEST_ASSERT_EQUAL(PARSE_OK, parseCommand(timeSync, sizeof(timeSync), command));
+    TEST_ASSERT_EQUAL_UINT32(1000000, command.timeSync.sharedMs);
+    TEST_ASSERT_EQUAL_INT(-150, command.timeSync.driftPpm);
+
+    const uint8_t sleepTimer[] = {CMD_SET_SLEEP_TIMER, 0x00, 0x1E};
+    TEST_ASSERT_EQUAL(PARSE_OK, parseCommand(sleepTimer, sizeof(sleepTimer), command));
+    TEST_ASSERT_EQUAL_UINT16(30, command.sleepTimer.minutes);
+}
+
+void test_invalid_commands_are_rejected(void)
+{
+    Command command;
+    const uint8_t unknown[] = {0x7F, 0};
+    const uint8_t shortColor[] = {CMD_SET_COLOR, 1, 2, 3};
+    const uint8_t oddColors[] = {CMD_SET_COLOR_SETS, 1, 2, 3, 4, 5};
+    const uint8_t paletteOverflow[] = {CMD_SET_PALETTE, 0xFF, 1, 2, 3, 4, 5, 6, 7, 8};
+    const uint8_t badDepth[] = {CMD_SET_INDEXED_COLORS, 3, 0, 0, 0xAB};
+    const uint8_t oddWideDepth[] = {CMD_SET_INDEXED_COLORS, 8 | INDEXED_ODD_COUNT, 0, 0, 0xAB};
+
+    TEST_ASSERT_EQUAL(PARSE_EMPTY, parseCommand(nullptr, 0, command));
+    TEST_ASSERT_EQUAL(PARSE_UNKNOWN_COMMAND, parseCommand(unknown, sizeof(unknown), command));
+    TEST_ASSERT_EQUAL(PARSE_INVALID_LENGTH, parseCommand(shortColor, sizeof(shortColor), command));
+    TEST_ASSERT_EQUAL(PARSE_INVALID_LENGTH, parseCommand(oddColors, sizeof(oddColors), command));
+    TEST_ASSERT_EQUAL(PARSE_INVALID_VALUE, parseCommand(paletteOverflow, sizeof(paletteOverflow), command));
+    TEST_ASSERT_EQUAL(PARSE_INVALID_VALUE, parseCommand(badDepth, sizeof(badDepth), command));
+    TEST_ASSERT_EQUAL(PARSE_INVALID_VALUE, parseCommand(oddWideDepth, sizeof(oddWideDepth), command));
+}
+
+void test_fuzz_random_inputs(void)
+{
+    Command command;
+    uint32_t accepted = 0;
+
+    for (uint32_t i = 0; i < FUZZ_ITERATIONS; i++) {
+        // Bias the first byte towards real command IDs so the payload checks are exercised
+        size_t length = testRandom() % FUZZ_MAX_LENGTH;
+        for (size_t j = 0; j < length; j++) {
+            input[j] = (uint8_t)testRandom();
+        }
+        if (length > 0 && (testRandom() & 3) != 0) {
+            input[0] = testRandom() % (COMMAND_COUNT + 1);
+        }
+
+        ParseResult result = parseCommand(input, length, command);
+        if (result == PARSE_OK) {
+            accepted++;
+            TEST_ASSERT_TRUE(commandIsConsistent(input, length, command));
+        } else if (length == 0) {
+            TEST_ASSERT_EQUAL(PARSE_EMPTY, result);
+        }
+    }
+
+    TEST_REPORT("%lu of %d random inputs accepted", (unsigned long)accepted, FUZZ_ITERATIONS);
+    TEST_ASSERT_TRUE(accepted > 0);
+}
+
+void test_benchmark_commands_per_second(void)
+{
+    const uint8_t setColor[] = {CMD_SET_COLOR, 1, 2, 3, 4};
+    const uint8_t animation[] = {CMD_SET_ANIMATION, 1, 20, 0, 0, 0, 0, 0, 0, 0, 0};
+    const uint8_t timeSync[] = {CMD_SET_TIME_SYNC, 0x00, 0x0F, 0x42, 0x40};
+    uint8_t packed[4 + NUM_LEDS * 2] = {CMD_SET_PACKED_COLORS, PIXEL_FORMAT_RGB565, 0, 0};
+    const uint8_t *inputs[] = {setColor, animation, timeSync, packed};
+    const size_t lengths[] = {sizeof(setColor), sizeof(animation), sizeof(timeSync), sizeof(packed)};
+
+    Command command;
+    volatile uint32_t sink = 0;
+    uint32_t i = 0;
+    double nanos = testNanosPerCall(BENCH_ITERATIONS, [&]() {
+        sink = sink + parseCommand(inputs[i & 3], lengths[i & 3], command) + command.length;
+        i++;
+    });
+    TEST_REPORT("parseCommand: %.1f M commands/s", 1000.0 / nanos);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_known_commands_parse);
+    RUN_TEST(test_invalid_commands_are_rejected);
+    RUN_TEST(test_fuzz_random_inputs);
+    RUN_TEST(test_benchmark_commands_per_second);
+    return UNITY_END();
+}
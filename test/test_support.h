@@ -0,0 +1,49 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <unity.h>
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+
+// Deterministic LCG so simulations and fuzz runs are reproducible between hosts
+static uint32_t testRandomState = 1;
+
+static inline void testSeedRandom(uint32_t seed)
+{
+    testRandomState = seed;
+}
+
+static inline uint32_t testRandom()
+{
+    testRandomState = testRandomState * 1664525 + 1013904223;
+    return testRandomState >> 8;
+}
+
+static inline void testFillRandom(uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        data[i] = (uint8_t)testRandom();
+    }
+}
+
+// printf-style line in the test runner output, for measured values
+#define TEST_REPORT(...)                                                   \
+    do {                                                                   \
+        char testReportLine[160];                                          \
+        snprintf(testReportLine, sizeof(testReportLine), __VA_ARGS__);     \
+        TEST_MESSAGE(testReportLine);                                      \
+    } while (0)
+
+template <typename F>
+static double testNanosPerCall(uint32_t iterations, F call)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        call();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include "../test_support.h"
+#include "time_sync.h"
+
+// One controller clock, bulbs with crystal error and BLE delivery jitter
+#define SIM_BULBS 2
+#define SIM_DURATION_MS (2 * 3600 * 1000UL)
+#define SIM_SYNC_INTERVAL_MS 60000
+#define SIM_SAMPLE_INTERVAL_MS 250
+#define SIM_JITTER_MS 40
+#define SIM_SETTLE_SYNCS 3
+#define SIM_MAX_BULB_ERROR_MS (SIM_JITTER_MS + 15)  // Delivery jitter plus residual drift between syncs
+#define SIM_MAX_GROUP_ERROR_MS (SIM_JITTER_MS + 15)
+
+struct SimBulb {
+    int32_t ppm;
+    uint32_t bootOffset;
+    TimeSync sync;
+};
+
+static uint32_t localClock(const SimBulb &bulb, uint64_t trueMs)
+{
+    return bulb.bootOffset + (uint32_t)(trueMs + (int64_t)trueMs * bulb.ppm / 1000000);
+}
+
+static void reportErrors(const char *label, int32_t bulbError, int32_t groupError)
+{
+    TEST_REPORT("%s: max bulb error %ld ms, max inter-bulb error %ld ms", label, (long)bulbError, (long)groupError);
+}
+
+static int32_t abs32(int32_t value)
+{
+    return value < 0 ? -value : value;
+}
+
+static void runSkewSimulation(int32_t ppmA, int32_t ppmB, int32_t *maxBulbError, int32_t *maxGroupError)
+{
+    // Start near the 32-bit wrap so millis() rollover is covered too
+    SimBulb bulbs[SIM_BULBS] = {{ppmA, 0xFFF00000u, {}}, {ppmB, 12345, {}}};
+    for (int i = 0; i < SIM_BULBS; i++) {
+        timeSyncInit(bulbs[i].sync);
+    }
+
+    *maxBulbError = 0;
+    *maxGroupError = 0;
+    uint64_t nextSync = 0;
+    int syncs = 0;
+
+    for (uint64_t t = 0; t < SIM_DURATION_MS; t += SIM_SAMPLE_INTERVAL_MS) {
+        int32_t errors[SIM_BULBS];
+        bool settled = syncs > SIM_SETTLE_SYNCS;
+        for (int i = 0; i < SIM_BULBS; i++) {
+            errors[i] = (int32_t)(timeSyncNow(bulbs[i].sync, localClock(bulbs[i], t)) - (uint32_t)t);
+            if (settled && abs32(errors[i]) > *maxBulbError) *maxBulbError = abs32(errors[i]);
+        }
+        int32_t groupError = abs32(errors[0] - errors[1]);
+        if (settled && groupError > *maxGroupError) *maxGroupError = groupError;
+
+        // Sample before delivering a sync, the bulb never reads its clock ahead of the last anchor
+        if (t >= nextSync) {
+            // The same shared time is sent to every bulb, each sees its own delivery delay
+            for (int i = 0; i < SIM_BULBS; i++) {
+                uint64_t arrival = t + testRandom() % (SIM_JITTER_MS + 1);
+                timeSyncApplyEstimate(bulbs[i].sync, localClock(bulbs[i], arrival), (uint32_t)t);
+            }
+            nextSync += SIM_SYNC_INTERVAL_MS;
+            syncs++;
+        }
+    }
+}
+
+void setUp(void)
+{
+    testSeedRandom(1);
+}
+
+void tearDown(void) {}
+
+void test_opposite_skew_stays_bounded(void)
+{
+    int32_t bulbError, groupError;
+    runSkewSimulation(200, -200, &bulbError, &groupError);
+    reportErrors("+/-200 ppm", bulbError, groupError);
+    TEST_ASSERT_LESS_OR_EQUAL(SIM_MAX_BULB_ERROR_MS, bulbError);
+    TEST_ASSERT_LESS_OR_EQUAL(SIM_MAX_GROUP_ERROR_MS, groupError);
+}
+
+void test_same_skew_stays_bounded(void)
+{
+    int32_t bulbError, groupError;
+    runSkewSimulation(200, 200, &bulbError, &groupError);
+    reportErrors("+200 ppm", bulbError, groupError);
+    TEST_ASSERT_LESS_OR_EQUAL(SIM_MAX_BULB_ERROR_MS, bulbError);
+    TEST_ASSERT_LESS_OR_EQUAL(SIM_MAX_GROUP_ERROR_MS, groupError);
+}
+
+void test_drift_estimate_converges(void)
+{
+    SimBulb bulb = {-200, 0, {}};
+    timeSyncInit(bulb.sync);
+    for (uint64_t t = 0; t < SIM_DURATION_MS; t += SIM_SYNC_INTERVAL_MS) {
+        uint64_t arrival = t + testRandom() % (SIM_JITTER_MS + 1);
+        timeSyncApplyEstimate(bulb.sync, localClock(bulb, arrival), (uint32_t)t);
+    }
+    // The shared clock runs ~200 ppm faster than this bulb
+    TEST_ASSERT_INT_WITHIN(50, 200, bulb.sync.driftPpm);
+}
+
+void test_explicit_drift_is_clamped(void)
+{
+    TimeSync sync;
+    timeSyncInit(sync);
+    TEST_ASSERT_EQUAL_UINT32(1234, timeSyncNow(sync, 1234));
+    timeSyncApply(sync, 1000, 500000, 5000);
+    TEST_ASSERT_EQUAL_INT32(1000, sync.driftPpm);
+    TEST_ASSERT_EQUAL_UINT32(500000 + 100000 + 100, timeSyncNow(sync, 101000));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_opposite_skew_stays_bounded);
+    RUN_TEST(test_same_skew_stays_bounded);
+    RUN_TEST(test_drift_estimate_converges);
+    RUN_TEST(test_explicit_drift_is_clamped);
+    return UNITY_END();
+}